@@ -15,7 +15,7 @@ public class ChainConstraint : ModuleRules
             "Chaos",
             "ChaosSolverEngine",
             "PhysicsCore",
-            "ProceduralMeshComponent" // optionnel, utile plus tard
+            "ProceduralMeshComponent"
         });
 
         PrivateDependencyModuleNames.AddRange(new string[]
@@ -0,0 +1,102 @@
+#include "ChainAnchorTracker.h"
+#include "Components/SkinnedMeshComponent.h"
+#include "CoreGlobals.h"
+
+/** Frames a component stays tracked after the last anchor used it. */
+static constexpr uint64 ChainAnchorTrackingFrames = 120;
+
+FChainAnchorTracker::~FChainAnchorTracker()
+{
+	Reset();
+}
+
+void FChainAnchorTracker::BeginFrame(float InDeltaTime)
+{
+	DeltaTime = InDeltaTime;
+
+	for (auto It = Components.CreateIterator(); It; ++It)
+	{
+		FTrackedComponent& Tracked = It.Value();
+		if (!Tracked.Component.IsValid() || GFrameCounter - Tracked.UsedFrame > ChainAnchorTrackingFrames)
+		{
+			Untrack(Tracked);
+			It.RemoveCurrent();
+		}
+	}
+}
+
+FVector FChainAnchorTracker::Resolve(USceneComponent* Component, FName SocketName, FVector* OutVelocity)
+{
+	check(Component);
+
+	FTrackedComponent* Tracked = Components.Find(Component);
+	if (!Tracked)
+	{
+		Tracked = &Components.Add(Component);
+		Tracked->Component = Component;
+		Tracked->bSkinned = Component->IsA<USkinnedMeshComponent>();
+		Tracked->TransformUpdatedHandle = Component->TransformUpdated.AddRaw(this, &FChainAnchorTracker::OnTransformUpdated);
+	}
+	Tracked->UsedFrame = GFrameCounter;
+
+	FTrackedSocket* Socket = Tracked->Sockets.FindByPredicate([SocketName](const FTrackedSocket& Candidate)
+	{
+		return Candidate.SocketName == SocketName;
+	});
+
+	if (!Socket || Socket->Frame != GFrameCounter)
+	{
+		// A moved component is evaluated again on the frame after the move too, in case it moved after this evaluation
+		const bool bFirst = !Socket;
+		const bool bMoved = bFirst || Tracked->MovedFrame >= Socket->Frame || (Tracked->bSkinned && SocketName != NAME_None);
+		if (bFirst)
+		{
+			Socket = &Tracked->Sockets.AddDefaulted_GetRef();
+			Socket->SocketName = SocketName;
+		}
+
+		const FVector Location = !bMoved ? Socket->Location
+			: SocketName != NAME_None ? Component->GetSocketLocation(SocketName) : Component->GetComponentLocation();
+
+		// Velocity over the last frame only: skipped frames and teleports do not count as motion
+		const bool bContinuous = !bFirst && Socket->Frame + 1 == GFrameCounter && Tracked->TeleportFrame < Socket->Frame && DeltaTime > UE_SMALL_NUMBER;
+		Socket->Velocity = bContinuous ? (Location - Socket->Location) / DeltaTime : FVector::ZeroVector;
+		Socket->Location = Location;
+		Socket->Frame = GFrameCounter;
+	}
+
+	if (OutVelocity)
+	{
+		*OutVelocity = Socket->Velocity;
+	}
+	return Socket->Location;
+}
+
+void FChainAnchorTracker::Reset()
+{
+	for (TPair<TObjectKey<USceneComponent>, FTrackedComponent>& Pair : Components)
+	{
+		Untrack(Pair.Value);
+	}
+	Components.Reset();
+}
+
+void FChainAnchorTracker::OnTransformUpdated(USceneComponent* Component, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	if (FTrackedComponent* Tracked = Components.Find(Component))
+	{
+		Tracked->MovedFrame = GFrameCounter;
+		if (Teleport != ETeleportType::None)
+		{
+			Tracked->TeleportFrame = GFrameCounter;
+		}
+	}
+}
+
+void FChainAnchorTracker::Untrack(FTrackedComponent& Tracked)
+{
+	if (USceneComponent* Component = Tracked.Component.Get())
+	{
+		Component->TransformUpdated.Remove(Tracked.TransformUpdatedHandle);
+	}
+}
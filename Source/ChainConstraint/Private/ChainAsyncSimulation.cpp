@@ -0,0 +1,178 @@
+#include "ChainAsyncSimulation.h"
+#include "ChainStats.h"
+#include "Async/ParallelFor.h"
+#include "PBDRigidsSolver.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+void FChainAsyncCallback::ApplyCommands_Internal(TArray<FChainSolverCommand>& Commands)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChainAsyncCallback::ApplyCommands_Internal);
+
+	for (FChainSolverCommand& Command : Commands)
+	{
+		Command(Solver);
+	}
+}
+
+void FChainAsyncCallback::OnPreSimulate_Internal()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChainAsyncCallback::OnPreSimulate_Internal);
+	SCOPE_CYCLE_COUNTER(STAT_ChainSolve);
+
+	if (const FChainAsyncInput* Input = GetConsumerInput_Internal())
+	{
+		Gravity = Input->Gravity;
+		Islands = Input->Islands;
+		ChainIds = Input->ChainIds;
+	}
+
+	// Every island runs at the fixed physics tick, split into its substeps
+	const float DeltaTime = static_cast<float>(GetDeltaTime_Internal());
+	const int32 NumParticles = Solver.GetBuffer().Num();
+	ParallelFor(Islands.Num(), [this, DeltaTime, NumParticles](int32 IslandIndex)
+	{
+		const FChainAsyncIsland& Island = Islands[IslandIndex];
+		if (Island.End > NumParticles) return;
+
+		const int32 NumSubsteps = FMath::Max(1, Island.NumSubsteps);
+		for (int32 Substep = 0; Substep < NumSubsteps; ++Substep)
+		{
+			if (Island.Spans.Num() > 0)
+			{
+				Solver.StepRanges(Island.Spans, Island.Pairs, DeltaTime / NumSubsteps, Gravity, Island.Iterations);
+			}
+			else
+			{
+				Solver.StepRange(Island.Begin, Island.End, DeltaTime / NumSubsteps, Gravity, Island.Iterations);
+			}
+		}
+	});
+
+	FChainAsyncOutput& Output = GetProducerOutputData_Internal();
+	Output.SimTime = GetSimTime_Internal() + DeltaTime;
+	Output.Chains.Reserve(ChainIds.Num());
+	for (int32 ChainId : ChainIds)
+	{
+		if (!Solver.IsValidChain(ChainId)) continue;
+
+		FChainAsyncChainPose& Pose = Output.Chains.AddDefaulted_GetRef();
+		Pose.ChainId = ChainId;
+		Pose.Revision = Solver.GetChainRevision(ChainId);
+		Solver.GetParticleState(ChainId, Pose.Positions, Pose.Velocities);
+	}
+}
+
+FChainAsyncSimulation::FChainAsyncSimulation(Chaos::FPBDRigidsSolver& InPhysicsSolver, const FChainXPBDSolver& InitialState)
+	: PhysicsSolver(InPhysicsSolver)
+{
+	Callback = PhysicsSolver.CreateAndRegisterSimCallbackObject_External<FChainAsyncCallback>();
+
+	// The mirror starts from the current particle state, later commands keep it in sync
+	PendingCommands.Emplace([InitialState](FChainXPBDSolver& Mirror)
+	{
+		Mirror = InitialState;
+		Mirror.SetCommandRecording(nullptr);
+	});
+	FlushCommands();
+}
+
+FChainAsyncSimulation::~FChainAsyncSimulation()
+{
+	PreviousOutput.Reset();
+	LatestOutput.Reset();
+
+	if (Callback)
+	{
+		PhysicsSolver.UnregisterAndFreeSimCallbackObject_External(Callback);
+		Callback = nullptr;
+	}
+}
+
+void FChainAsyncSimulation::FlushCommands()
+{
+	if (PendingCommands.Num() == 0) return;
+
+	// Commands are executed in order before the next physics tick, unlike inputs which only keep the latest
+	PhysicsSolver.EnqueueCommandImmediate([Callback = Callback, Commands = MoveTemp(PendingCommands)]() mutable
+	{
+		Callback->ApplyCommands_Internal(Commands);
+	});
+	PendingCommands.Reset();
+}
+
+void FChainAsyncSimulation::PushInput(const FVector& Gravity, TConstArrayView<FChainAsyncIsland> Islands, TConstArrayView<int32> ChainIds)
+{
+	FlushCommands();
+
+	FChainAsyncInput* Input = Callback->GetProducerInputData_External();
+	Input->Gravity = Gravity;
+	Input->Islands.Reset();
+	Input->Islands.Append(Islands.GetData(), Islands.Num());
+	Input->ChainIds.Reset();
+	Input->ChainIds.Append(ChainIds.GetData(), ChainIds.Num());
+}
+
+void FChainAsyncSimulation::PullResults(FChainXPBDSolver& Solver)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChainAsyncSimulation::PullResults);
+
+	while (Chaos::TSimCallbackOutputHandle<FChainAsyncOutput> Output = Callback->PopOutputData_External())
+	{
+		PreviousOutput = MoveTemp(LatestOutput);
+		LatestOutput = MoveTemp(Output);
+	}
+
+	if (!LatestOutput) return;
+
+	// The game thread renders at the physics results time, which lies between the last two steps
+	float Alpha = 1.0f;
+	if (PreviousOutput && LatestOutput->SimTime > PreviousOutput->SimTime)
+	{
+		const double ResultsTime = PhysicsSolver.GetPhysicsResultsTime_External();
+		Alpha = static_cast<float>(FMath::Clamp((ResultsTime - PreviousOutput->SimTime) / (LatestOutput->SimTime - PreviousOutput->SimTime), 0.0, 1.0));
+	}
+
+	for (int32 Index = 0; Index < LatestOutput->Chains.Num(); ++Index)
+	{
+		const FChainAsyncChainPose& Pose = LatestOutput->Chains[Index];
+
+		// Layout commands the physics thread has not run yet
+		if (!Solver.IsValidChain(Pose.ChainId) || Solver.GetChainRevision(Pose.ChainId) != Pose.Revision) continue;
+
+		// Both steps usually list the same chains in the same order
+		const FChainAsyncChainPose* PreviousPose = nullptr;
+		if (PreviousOutput && Alpha < 1.0f)
+		{
+			const TArray<FChainAsyncChainPose>& PreviousChains = PreviousOutput->Chains;
+			if (PreviousChains.IsValidIndex(Index) && PreviousChains[Index].ChainId == Pose.ChainId)
+			{
+				PreviousPose = &PreviousChains[Index];
+			}
+			else
+			{
+				PreviousPose = PreviousChains.FindByPredicate([&Pose](const FChainAsyncChainPose& Candidate)
+				{
+					return Candidate.ChainId == Pose.ChainId;
+				});
+			}
+
+			if (PreviousPose && PreviousPose->Revision != Pose.Revision)
+			{
+				PreviousPose = nullptr;
+			}
+		}
+
+		if (!PreviousPose)
+		{
+			Solver.SetParticleState(Pose.ChainId, Pose.Positions, Pose.Velocities);
+			continue;
+		}
+
+		BlendedPositions.SetNumUninitialized(Pose.Positions.Num());
+		for (int32 Particle = 0; Particle < Pose.Positions.Num(); ++Particle)
+		{
+			BlendedPositions[Particle] = FMath::Lerp(PreviousPose->Positions[Particle], Pose.Positions[Particle], Alpha);
+		}
+		Solver.SetParticleState(Pose.ChainId, BlendedPositions, Pose.Velocities);
+	}
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Chaos/SimCallbackInput.h"
+#include "Chaos/SimCallbackObject.h"
+#include "ChainXPBDSolver.h"
+
+namespace Chaos
+{
+	class FPBDRigidsSolver;
+}
+
+/** Particle range stepped on the physics thread. */
+struct FChainAsyncIsland
+{
+	int32 Begin = 0;
+	int32 End = 0;
+	int32 Iterations = 0;
+	int32 NumSubsteps = 1;
+
+	/** Chains colliding with each other: their ranges and cross-chain segment pairs. Begin and End bound the spans. */
+	TArray<FChainParticleSpan> Spans;
+	TArray<FChainSegmentPair> Pairs;
+};
+
+/** Per-frame step parameters, marshalled to the physics thread. The latest one is used until a newer one arrives. */
+struct FChainAsyncInput : public Chaos::FSimCallbackInput
+{
+	FVector Gravity = FVector::ZeroVector;
+	TArray<FChainAsyncIsland> Islands;
+
+	/** Chains whose pose is sent back after each step. */
+	TArray<int32> ChainIds;
+
+	void Reset()
+	{
+		Islands.Reset();
+		ChainIds.Reset();
+	}
+};
+
+/** Pose of one chain after a physics step. */
+struct FChainAsyncChainPose
+{
+	int32 ChainId = INDEX_NONE;
+	uint32 Revision = 0;
+	TArray<FVector3f> Positions;
+	TArray<FVector3f> Velocities;
+};
+
+/** Chain poses produced by one physics step. */
+struct FChainAsyncOutput : public Chaos::FSimCallbackOutput
+{
+	/** Physics time the poses are at. */
+	double SimTime = 0.0;
+	TArray<FChainAsyncChainPose> Chains;
+
+	void Reset()
+	{
+		SimTime = 0.0;
+		Chains.Reset();
+	}
+};
+
+/**
+ * Physics thread side: owns a mirror of the game thread solver and steps it before every physics tick.
+ * The mirror is only changed by replayed game thread commands and by its own steps.
+ */
+class FChainAsyncCallback : public Chaos::TSimCallbackObject<FChainAsyncInput, FChainAsyncOutput>
+{
+public:
+
+	/** Replays game thread solver mutations, in order. Physics thread only. */
+	void ApplyCommands_Internal(TArray<FChainSolverCommand>& Commands);
+
+private:
+
+	virtual void OnPreSimulate_Internal() override;
+
+	FChainXPBDSolver Solver;
+
+	/** Last received step parameters. */
+	FVector Gravity = FVector::ZeroVector;
+	TArray<FChainAsyncIsland> Islands;
+	TArray<int32> ChainIds;
+};
+
+/**
+ * Game thread side: registers the callback on the world's physics solver, forwards recorded solver commands,
+ * writes the step parameters and interpolates the returned poses back into the game thread solver.
+ */
+class FChainAsyncSimulation
+{
+public:
+
+	/** Registers the callback; its mirror starts as a copy of InitialState. */
+	FChainAsyncSimulation(Chaos::FPBDRigidsSolver& InPhysicsSolver, const FChainXPBDSolver& InitialState);
+
+	/** Unregisters the callback. Commands recorded since the last flush are dropped. */
+	~FChainAsyncSimulation();
+
+	/** Queue the game thread solver records its commands into. */
+	TArray<FChainSolverCommand>& GetCommandQueue() { return PendingCommands; }
+
+	/** Sends the recorded commands to the physics thread. */
+	void FlushCommands();
+
+	/** Sends the recorded commands, then the step parameters for the next physics ticks. */
+	void PushInput(const FVector& Gravity, TConstArrayView<FChainAsyncIsland> Islands, TConstArrayView<int32> ChainIds);
+
+	/**
+	 * Pops the poses produced so far and writes them, interpolated at the physics results time, into Solver.
+	 * Chains whose layout changed since the pose was produced are left untouched.
+	 */
+	void PullResults(FChainXPBDSolver& Solver);
+
+private:
+
+	Chaos::FPBDRigidsSolver& PhysicsSolver;
+	FChainAsyncCallback* Callback = nullptr;
+	TArray<FChainSolverCommand> PendingCommands;
+
+	/** Last two outputs, interpolated between. */
+	Chaos::TSimCallbackOutputHandle<FChainAsyncOutput> PreviousOutput;
+	Chaos::TSimCallbackOutputHandle<FChainAsyncOutput> LatestOutput;
+
+	/** Scratch for interpolated poses. */
+	TArray<FVector3f> BlendedPositions;
+};
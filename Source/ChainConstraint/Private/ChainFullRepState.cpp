@@ -0,0 +1,321 @@
+#include "ChainFullRepState.h"
+#include "ChainStats.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+
+/** Quantized pose a connection is known to hold, kept by the replication system per connection. */
+class FChainFullRepBaseState : public INetDeltaBaseState
+{
+public:
+
+	FVector Root = FVector::ZeroVector;
+	float Length = 0.0f;
+	int32 PositionBits = 0;
+	int32 RotationBits = 0;
+	float Range = 0.0f;
+	TArray<FIntVector> Positions;
+	TArray<uint32> Rotations;
+
+	virtual bool IsStateEqual(INetDeltaBaseState* OtherState) override
+	{
+		const FChainFullRepBaseState* Other = static_cast<const FChainFullRepBaseState*>(OtherState);
+		return Other
+			&& Root == Other->Root
+			&& Length == Other->Length
+			&& HasSameLayout(*Other)
+			&& Positions == Other->Positions
+			&& Rotations == Other->Rotations;
+	}
+
+	/** True if a delta against Other can be sent, false if a full state is needed. */
+	bool HasSameLayout(const FChainFullRepBaseState& Other) const
+	{
+		return PositionBits == Other.PositionBits
+			&& RotationBits == Other.RotationBits
+			&& Range == Other.Range
+			&& Positions.Num() == Other.Positions.Num()
+			&& Rotations.Num() == Other.Rotations.Num();
+	}
+};
+
+namespace ChainFullRep
+{
+	static int32 QuantizeAxis(double Value, float Range, int32 Bits)
+	{
+		const int32 MaxValue = (1 << Bits) - 1;
+		const double Normalized = (FMath::Clamp(Value, -Range, Range) + Range) / (2.0 * Range);
+		return FMath::Clamp(FMath::RoundToInt(Normalized * MaxValue), 0, MaxValue);
+	}
+
+	static double DequantizeAxis(int32 Value, float Range, int32 Bits)
+	{
+		const int32 MaxValue = (1 << Bits) - 1;
+		return static_cast<double>(Value) / MaxValue * (2.0 * Range) - Range;
+	}
+
+	/** Smallest-three: index of the largest component on 2 bits, the other three on Bits bits each. */
+	static uint32 PackQuat(FQuat Quat, int32 Bits)
+	{
+		Quat.Normalize();
+		const double Components[4] = { Quat.X, Quat.Y, Quat.Z, Quat.W };
+
+		int32 Largest = 0;
+		for (int32 Index = 1; Index < 4; ++Index)
+		{
+			if (FMath::Abs(Components[Index]) > FMath::Abs(Components[Largest]))
+			{
+				Largest = Index;
+			}
+		}
+
+		// q and -q are the same rotation: flip so the dropped component is positive
+		const double Sign = Components[Largest] < 0.0 ? -1.0 : 1.0;
+		const uint32 MaxValue = (1u << Bits) - 1;
+
+		uint32 Packed = static_cast<uint32>(Largest);
+		int32 Shift = 2;
+		for (int32 Index = 0; Index < 4; ++Index)
+		{
+			if (Index == Largest) continue;
+
+			// The other components lie in [-1/sqrt(2), 1/sqrt(2)]
+			const double Normalized = (Components[Index] * Sign * UE_SQRT_2 + 1.0) * 0.5;
+			const uint32 Value = static_cast<uint32>(FMath::Clamp(FMath::RoundToInt(Normalized * MaxValue), 0, static_cast<int32>(MaxValue)));
+			Packed |= Value << Shift;
+			Shift += Bits;
+		}
+		return Packed;
+	}
+
+	static FQuat UnpackQuat(uint32 Packed, int32 Bits)
+	{
+		const int32 Largest = Packed & 3u;
+		const uint32 MaxValue = (1u << Bits) - 1;
+
+		double Components[4];
+		double SumSq = 0.0;
+		int32 Shift = 2;
+		for (int32 Index = 0; Index < 4; ++Index)
+		{
+			if (Index == Largest) continue;
+
+			const uint32 Value = (Packed >> Shift) & MaxValue;
+			Components[Index] = (static_cast<double>(Value) / MaxValue * 2.0 - 1.0) * UE_INV_SQRT_2;
+			SumSq += Components[Index] * Components[Index];
+			Shift += Bits;
+		}
+		Components[Largest] = FMath::Sqrt(FMath::Max(0.0, 1.0 - SumSq));
+
+		return FQuat(Components[0], Components[1], Components[2], Components[3]).GetNormalized();
+	}
+}
+
+bool FChainFullRepState::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+{
+	using namespace ChainFullRep;
+
+	if (DeltaParms.Writer)
+	{
+		FBitWriter& Writer = *DeltaParms.Writer;
+		const int64 StartBits = Writer.GetNumBits();
+
+		// Quantize the current pose
+		TSharedPtr<FChainFullRepBaseState> NewState = MakeShared<FChainFullRepBaseState>();
+		NewState->PositionBits = FMath::Clamp(PositionBits, 8, 24);
+		NewState->RotationBits = FMath::Clamp(RotationBits, 6, 10);
+		NewState->Range = FMath::Max(1.0f, Range);
+		NewState->Root = FVector(FMath::RoundToDouble(Root.X * 100.0), FMath::RoundToDouble(Root.Y * 100.0), FMath::RoundToDouble(Root.Z * 100.0)) / 100.0;
+		NewState->Length = Length;
+
+		NewState->Positions.SetNumUninitialized(Offsets.Num());
+		for (int32 Index = 0; Index < Offsets.Num(); ++Index)
+		{
+			NewState->Positions[Index] = FIntVector(
+				QuantizeAxis(Offsets[Index].X, NewState->Range, NewState->PositionBits),
+				QuantizeAxis(Offsets[Index].Y, NewState->Range, NewState->PositionBits),
+				QuantizeAxis(Offsets[Index].Z, NewState->Range, NewState->PositionBits));
+		}
+
+		NewState->Rotations.SetNumUninitialized(Rotations.Num());
+		for (int32 Index = 0; Index < Rotations.Num(); ++Index)
+		{
+			NewState->Rotations[Index] = PackQuat(Rotations[Index], NewState->RotationBits);
+		}
+
+		FChainFullRepBaseState* OldState = static_cast<FChainFullRepBaseState*>(DeltaParms.OldState);
+		if (OldState && OldState->IsStateEqual(NewState.Get()))
+		{
+			return false;
+		}
+
+		const bool bFullState = !OldState || !OldState->HasSameLayout(*NewState);
+		Writer.WriteBit(bFullState ? 1 : 0);
+
+		SerializePackedVector<100, 30>(NewState->Root, Writer);
+
+		uint8 bLengthChanged = bFullState || OldState->Length != NewState->Length;
+		Writer.WriteBit(bLengthChanged);
+		if (bLengthChanged)
+		{
+			Writer << NewState->Length;
+		}
+
+		const int32 RotationPackedBits = 2 + 3 * NewState->RotationBits;
+		const int32 NumPoints = NewState->Positions.Num();
+		const bool bHasRotations = NewState->Rotations.Num() == NumPoints && NumPoints > 0;
+
+		if (bFullState)
+		{
+			uint32 Header[3] = { static_cast<uint32>(NewState->PositionBits), static_cast<uint32>(NewState->RotationBits), static_cast<uint32>(NumPoints) };
+			Writer.SerializeIntPacked(Header[0]);
+			Writer.SerializeIntPacked(Header[1]);
+			Writer.SerializeIntPacked(Header[2]);
+			Writer << NewState->Range;
+			Writer.WriteBit(bHasRotations ? 1 : 0);
+
+			for (int32 Index = 0; Index < NumPoints; ++Index)
+			{
+				FIntVector& Position = NewState->Positions[Index];
+				Writer.SerializeBits(&Position.X, NewState->PositionBits);
+				Writer.SerializeBits(&Position.Y, NewState->PositionBits);
+				Writer.SerializeBits(&Position.Z, NewState->PositionBits);
+
+				if (bHasRotations)
+				{
+					Writer.SerializeBits(&NewState->Rotations[Index], RotationPackedBits);
+				}
+			}
+		}
+		else
+		{
+			for (int32 Index = 0; Index < NumPoints; ++Index)
+			{
+				// Moved points are sent absolute so a lost state cannot leave the client drifting
+				FIntVector& Position = NewState->Positions[Index];
+				const uint8 bMoved = Position != OldState->Positions[Index];
+				Writer.WriteBit(bMoved);
+				if (bMoved)
+				{
+					Writer.SerializeBits(&Position.X, NewState->PositionBits);
+					Writer.SerializeBits(&Position.Y, NewState->PositionBits);
+					Writer.SerializeBits(&Position.Z, NewState->PositionBits);
+				}
+
+				if (bHasRotations)
+				{
+					const uint8 bRotated = NewState->Rotations[Index] != OldState->Rotations[Index];
+					Writer.WriteBit(bRotated);
+					if (bRotated)
+					{
+						Writer.SerializeBits(&NewState->Rotations[Index], RotationPackedBits);
+					}
+				}
+			}
+		}
+
+		INC_DWORD_STAT_BY(STAT_ChainReplicatedBytes, (Writer.GetNumBits() - StartBits + 7) / 8);
+
+		*DeltaParms.NewState = NewState;
+		return true;
+	}
+
+	if (DeltaParms.Reader)
+	{
+		FBitReader& Reader = *DeltaParms.Reader;
+
+		const bool bFullState = Reader.ReadBit() != 0;
+		SerializePackedVector<100, 30>(Root, Reader);
+
+		if (Reader.ReadBit())
+		{
+			Reader << Length;
+		}
+
+		if (bFullState)
+		{
+			uint32 Header[3] = { 0, 0, 0 };
+			Reader.SerializeIntPacked(Header[0]);
+			Reader.SerializeIntPacked(Header[1]);
+			Reader.SerializeIntPacked(Header[2]);
+			Reader << Range;
+
+			PositionBits = FMath::Clamp(static_cast<int32>(Header[0]), 8, 24);
+			RotationBits = FMath::Clamp(static_cast<int32>(Header[1]), 6, 10);
+			const int32 NumPoints = static_cast<int32>(Header[2]);
+			const bool bHasRotations = Reader.ReadBit() != 0;
+
+			if (NumPoints > 4096 || Reader.IsError())
+			{
+				Reader.SetError();
+				return false;
+			}
+
+			// SerializeBits only writes the low bytes of each value
+			QuantizedPositions.Reset(NumPoints);
+			QuantizedPositions.AddZeroed(NumPoints);
+			PackedRotations.Reset(NumPoints);
+			PackedRotations.AddZeroed(bHasRotations ? NumPoints : 0);
+
+			const int32 RotationPackedBits = 2 + 3 * RotationBits;
+			for (int32 Index = 0; Index < NumPoints; ++Index)
+			{
+				FIntVector& Position = QuantizedPositions[Index];
+				Reader.SerializeBits(&Position.X, PositionBits);
+				Reader.SerializeBits(&Position.Y, PositionBits);
+				Reader.SerializeBits(&Position.Z, PositionBits);
+
+				if (bHasRotations)
+				{
+					Reader.SerializeBits(&PackedRotations[Index], RotationPackedBits);
+				}
+			}
+		}
+		else
+		{
+			const bool bHasRotations = PackedRotations.Num() > 0;
+			const int32 RotationPackedBits = 2 + 3 * RotationBits;
+			for (int32 Index = 0; Index < QuantizedPositions.Num(); ++Index)
+			{
+				if (Reader.ReadBit())
+				{
+					FIntVector& Position = QuantizedPositions[Index];
+					Position = FIntVector::ZeroValue;
+					Reader.SerializeBits(&Position.X, PositionBits);
+					Reader.SerializeBits(&Position.Y, PositionBits);
+					Reader.SerializeBits(&Position.Z, PositionBits);
+				}
+
+				if (bHasRotations && Reader.ReadBit())
+				{
+					PackedRotations[Index] = 0;
+					Reader.SerializeBits(&PackedRotations[Index], RotationPackedBits);
+				}
+			}
+		}
+
+		if (Reader.IsError()) return false;
+
+		// Dequantize
+		Offsets.SetNumUninitialized(QuantizedPositions.Num());
+		for (int32 Index = 0; Index < QuantizedPositions.Num(); ++Index)
+		{
+			const FIntVector& Position = QuantizedPositions[Index];
+			Offsets[Index] = FVector(
+				DequantizeAxis(Position.X, Range, PositionBits),
+				DequantizeAxis(Position.Y, Range, PositionBits),
+				DequantizeAxis(Position.Z, Range, PositionBits));
+		}
+
+		Rotations.SetNumUninitialized(PackedRotations.Num());
+		for (int32 Index = 0; Index < PackedRotations.Num(); ++Index)
+		{
+			Rotations[Index] = UnpackQuat(PackedRotations[Index], RotationBits);
+		}
+
+		++ReceivedRevision;
+		return true;
+	}
+
+	// No object reference to gather or remap
+	return false;
+}
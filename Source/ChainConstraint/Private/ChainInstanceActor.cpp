@@ -1,203 +1,1518 @@
 #include "ChainInstanceActor.h"
+#include "ChainSimulationSubsystem.h"
+#include "ChainStats.h"
 #include "Components/StaticMeshComponent.h"
 #include "PhysicsEngine/PhysicsConstraintComponent.h"
+#include "ProceduralMeshComponent.h"
 #include "Engine/World.h"
 #include "Net/UnrealNetwork.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+/**
+ * Re-samples a polyline into NumSamples points evenly spaced along its length.
+ * Values given per point (e.g. particle velocities) are interpolated at the same places into OutValues.
+ */
+static void ResamplePolyline(TConstArrayView<FVector> Points, int32 NumSamples, TArray<FVector>& OutSamples,
+	TConstArrayView<FVector3f> Values = TConstArrayView<FVector3f>(), TArray<FVector3f>* OutValues = nullptr)
+{
+	check(!OutValues || Values.Num() == Points.Num());
+
+	OutSamples.Reset(NumSamples);
+	if (OutValues)
+	{
+		OutValues->Reset(NumSamples);
+	}
+	if (Points.Num() == 0 || NumSamples <= 0) return;
+
+	if (Points.Num() == 1 || NumSamples == 1)
+	{
+		OutSamples.Init(Points[0], NumSamples);
+		if (OutValues)
+		{
+			OutValues->Init(Values[0], NumSamples);
+		}
+		return;
+	}
+
+	TArray<double, TInlineAllocator<64>> Distances;
+	Distances.SetNumUninitialized(Points.Num());
+	Distances[0] = 0.0;
+	for (int32 i = 1; i < Points.Num(); ++i)
+	{
+		Distances[i] = Distances[i - 1] + FVector::Dist(Points[i - 1], Points[i]);
+	}
+
+	int32 Segment = 0;
+	for (int32 i = 0; i < NumSamples; ++i)
+	{
+		const double Target = Distances.Last() * i / (NumSamples - 1);
+		while (Segment < Points.Num() - 2 && Distances[Segment + 1] < Target)
+		{
+			++Segment;
+		}
+
+		const double SegmentLength = Distances[Segment + 1] - Distances[Segment];
+		const double Alpha = FMath::Clamp(SegmentLength > UE_KINDA_SMALL_NUMBER ? (Target - Distances[Segment]) / SegmentLength : 0.0, 0.0, 1.0);
+		OutSamples.Add(FMath::Lerp(Points[Segment], Points[Segment + 1], Alpha));
+		if (OutValues)
+		{
+			OutValues->Add(FMath::Lerp(Values[Segment], Values[Segment + 1], static_cast<float>(Alpha)));
+		}
+	}
+}
+
+/** Index of key Key out of NumKeys evenly spaced along a pose of NumPoints points (first and last included). */
+static int32 GetKeyPointIndex(int32 Key, int32 NumKeys, int32 NumPoints)
+{
+	return NumKeys > 1 ? FMath::RoundToInt(static_cast<float>(Key) * (NumPoints - 1) / (NumKeys - 1)) : 0;
+}
+
+/** Anchor displacement (cm) that wakes a sleeping chain up. */
+static constexpr float ChainWakeAnchorTolerance = 0.5f;
 
 AChainInstanceActor::AChainInstanceActor()
 {
-	PrimaryActorTick.bCanEverTick = false;
-	bReplicates = true;
+	PrimaryActorTick.bCanEverTick = false;
+	bReplicates = true;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+}
+
+void AChainInstanceActor::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (UChainSimulationSubsystem* Subsystem = GetSimulationSubsystem())
+	{
+		Subsystem->RegisterChainActor(this);
+	}
+
+	// Clients build their own chain too, following the server through the replicated state
+	InitializeFromProfile();
+}
+
+void AChainInstanceActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	ReleaseParticleChain();
+
+	if (UChainSimulationSubsystem* Subsystem = GetSimulationSubsystem())
+	{
+		Subsystem->UnregisterChainActor(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+bool AChainInstanceActor::UsesParticleSolver() const
+{
+	return Profile && Profile->UsesParticleSolver();
+}
+
+bool AChainInstanceActor::UsesInstancedLinks() const
+{
+	return Profile && Profile->UsesInstancedLinks();
+}
+
+bool AChainInstanceActor::UsesTubeMesh() const
+{
+	return Profile && Profile->UsesTubeMesh();
+}
+
+FVector AChainInstanceActor::GetLODReferenceLocation() const
+{
+	if (LinkComponents.Num() > 0 && LinkComponents[0])
+	{
+		return LinkComponents[0]->GetComponentLocation();
+	}
+	if (LinkTransforms.Num() > 0)
+	{
+		return LinkTransforms[0].GetLocation();
+	}
+	return GetActorLocation();
+}
+
+void AChainInstanceActor::OnConstruction(const FTransform& Transform)
+{
+	Super::OnConstruction(Transform);
+
+	if (Profile && bAutoRebuild)
+	{
+		InitializeFromProfile();
+	}
+}
+
+void AChainInstanceActor::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AChainInstanceActor, Profile);
+	DOREPLIFETIME(AChainInstanceActor, KeyLinkState);
+	DOREPLIFETIME(AChainInstanceActor, FullRepState);
+}
+
+void AChainInstanceActor::OnRep_Profile()
+{
+	// The initial build happens in BeginPlay
+	if (HasActorBegunPlay())
+	{
+		InitializeFromProfile();
+	}
+}
+
+void AChainInstanceActor::OnRep_KeyLinkState()
+{
+	const int32 NumKeys = KeyLinkState.KeyOffsets.Num() + 1;
+
+	ReceivedKeyPositions.SetNumUninitialized(NumKeys);
+	ReceivedKeyPositions[0] = KeyLinkState.Root;
+	for (int32 Key = 1; Key < NumKeys; ++Key)
+	{
+		ReceivedKeyPositions[Key] = KeyLinkState.Root + KeyLinkState.KeyOffsets[Key - 1];
+	}
+	ReceivedKeyRotations.Reset();
+
+	OnReceivedKeyPositions(KeyLinkState.Length);
+}
+
+void AChainInstanceActor::OnRep_FullRepState()
+{
+	// FullRep is KeyLinksRep with every pose point as a key
+	const int32 NumPoints = FullRepState.Offsets.Num();
+
+	ReceivedKeyPositions.SetNumUninitialized(NumPoints);
+	for (int32 Point = 0; Point < NumPoints; ++Point)
+	{
+		ReceivedKeyPositions[Point] = FullRepState.Root + FullRepState.Offsets[Point];
+	}
+	ReceivedKeyRotations = FullRepState.Rotations;
+
+	OnReceivedKeyPositions(FullRepState.Length);
+}
+
+void AChainInstanceActor::OnReceivedKeyPositions(float ReplicatedLength)
+{
+	// A new key layout snaps, later updates are blended
+	if (ClientKeyTargets.Num() != ReceivedKeyPositions.Num())
+	{
+		ClientKeyTargets = ReceivedKeyPositions;
+	}
+
+	if (UsesParticleSolver() && ReplicatedLength > 0.0f)
+	{
+		TargetLength = ReplicatedLength;
+	}
+
+	// The server pose moved
+	WakeUp();
+}
+
+bool AChainInstanceActor::IsReplicatedPoseClient() const
+{
+	if (HasAuthority() || !Profile || ClientKeyTargets.Num() < 2) return false;
+
+	const EChainNetworkMode Mode = Profile->NetworkSettings.NetworkMode;
+	return Mode == EChainNetworkMode::KeyLinksRep || Mode == EChainNetworkMode::FullRep;
+}
+
+void AChainInstanceActor::UpdateReplication(float DeltaTime)
+{
+	if (!Profile || !HasBuiltChain() || GetNetMode() == NM_Standalone) return;
+
+	const EChainNetworkMode Mode = Profile->NetworkSettings.NetworkMode;
+	if (Mode == EChainNetworkMode::None) return;
+
+	if (HasAuthority())
+	{
+		if (Mode == EChainNetworkMode::FullRep)
+		{
+			CaptureFullRepState();
+		}
+		else
+		{
+			CaptureKeyLinkState();
+		}
+		return;
+	}
+
+	if (!IsReplicatedPoseClient()) return;
+
+	const float InterpSpeed = Profile->NetworkSettings.KeyLinkInterpSpeed;
+	const float Alpha = InterpSpeed > 0.0f ? 1.0f - FMath::Exp(-InterpSpeed * DeltaTime) : 1.0f;
+	for (int32 Key = 0; Key < ClientKeyTargets.Num(); ++Key)
+	{
+		ClientKeyTargets[Key] = FMath::Lerp(ClientKeyTargets[Key], ReceivedKeyPositions[Key], Alpha);
+	}
+
+	// Particle chains get their targets in PushAnchorTargets, rigid links are driven here
+	if (UsesParticleSolver()) return;
+
+	PinKeyPoints();
+	const int32 NumKeys = ClientKeyTargets.Num();
+	const bool bApplyRotations = ReceivedKeyRotations.Num() == NumKeys && NumKeys == LinkComponents.Num();
+	for (int32 Key = 0; Key < NumKeys; ++Key)
+	{
+		UStaticMeshComponent* Link = LinkComponents[GetKeyPointIndex(Key, NumKeys, LinkComponents.Num())];
+		if (!Link || (Key == 0 && IsStartAnchorBound())) continue;
+
+		// LOD changes re-enable simulation on every link
+		if (Link->IsSimulatingPhysics())
+		{
+			Link->SetSimulatePhysics(false);
+		}
+
+		if (bApplyRotations)
+		{
+			Link->SetWorldLocationAndRotation(ClientKeyTargets[Key], ReceivedKeyRotations[Key]);
+		}
+		else
+		{
+			Link->SetWorldLocation(ClientKeyTargets[Key]);
+		}
+	}
+}
+
+void AChainInstanceActor::CaptureKeyLinkState()
+{
+	GetChainPose(NetPose);
+	if (NetPose.Num() < 2) return;
+
+	// Root plus the requested key links, spread evenly up to the end (2 = mid, end)
+	const int32 RequestedKeys = Profile->NetworkSettings.ReplicatedKeyLinksCount;
+	const int32 NumKeysAfterRoot = RequestedKeys > 0 ? RequestedKeys : FMath::Clamp(NetPose.Num() / 8, 1, 8);
+	const int32 NumKeys = FMath::Min(NetPose.Num(), NumKeysAfterRoot + 1);
+
+	// Only dirty the replicated state when a key moved noticeably
+	const float ToleranceSq = FMath::Square(Profile->NetworkSettings.KeyLinkTolerance);
+	const FVector Root = NetPose[0];
+	bool bChanged = KeyLinkState.KeyOffsets.Num() != NumKeys - 1
+		|| FVector::DistSquared(Root, KeyLinkState.Root) > ToleranceSq
+		|| FMath::Abs(KeyLinkState.Length - CurrentLength) > Profile->NetworkSettings.KeyLinkTolerance;
+
+	for (int32 Key = 1; Key < NumKeys && !bChanged; ++Key)
+	{
+		const FVector Offset = NetPose[GetKeyPointIndex(Key, NumKeys, NetPose.Num())] - Root;
+		bChanged = FVector::DistSquared(Offset, KeyLinkState.KeyOffsets[Key - 1]) > ToleranceSq;
+	}
+
+	if (!bChanged) return;
+
+	KeyLinkState.Root = Root;
+	KeyLinkState.Length = CurrentLength;
+	KeyLinkState.KeyOffsets.SetNum(NumKeys - 1);
+	for (int32 Key = 1; Key < NumKeys; ++Key)
+	{
+		KeyLinkState.KeyOffsets[Key - 1] = NetPose[GetKeyPointIndex(Key, NumKeys, NetPose.Num())] - Root;
+	}
+}
+
+void AChainInstanceActor::CaptureFullRepState()
+{
+	GetChainPose(NetPose);
+	if (NetPose.Num() < 2) return;
+
+	const FChainNetworkSettings& Net = Profile->NetworkSettings;
+	FullRepState.PositionBits = Net.FullRepPositionBits;
+	FullRepState.RotationBits = Net.FullRepRotationBits;
+	FullRepState.Range = Profile->GetMaxLength() * 1.25f; // Headroom for stretching
+	FullRepState.Root = NetPose[0];
+	FullRepState.Length = CurrentLength;
+
+	FullRepState.Offsets.SetNumUninitialized(NetPose.Num());
+	for (int32 Point = 0; Point < NetPose.Num(); ++Point)
+	{
+		FullRepState.Offsets[Point] = NetPose[Point] - NetPose[0];
+	}
+
+	// Particle chains derive link rotations from the particles, only rigid links need theirs
+	FullRepState.Rotations.Reset();
+	if (!UsesParticleSolver())
+	{
+		for (const UStaticMeshComponent* Link : LinkComponents)
+		{
+			FullRepState.Rotations.Add(Link ? Link->GetComponentQuat() : FQuat::Identity);
+		}
+	}
+}
+
+void AChainInstanceActor::PinKeyPoints()
+{
+	const bool bParticles = UsesParticleSolver();
+	UChainSimulationSubsystem* Subsystem = GetSimulationSubsystem();
+	if (bParticles && (!Subsystem || ParticleChainId == INDEX_NONE)) return;
+
+	const int32 NumPoints = bParticles ? Subsystem->GetSolver().GetNumParticles(ParticleChainId) : LinkComponents.Num();
+	const int32 NumKeys = ClientKeyTargets.Num();
+	if (NumPoints == PinnedKeyPointCount && PinnedKeyPoints.Num() == NumKeys) return;
+
+	// Release the previous keys. Reeling adds and removes points at the start, which shifts every index.
+	const int32 Shift = PinnedKeyPointCount > 0 ? NumPoints - PinnedKeyPointCount : 0;
+	for (const int32 OldPoint : PinnedKeyPoints)
+	{
+		const int32 Point = OldPoint + Shift;
+		const bool bAnchor = (Point == 0 && IsStartAnchorBound()) || (Point == NumPoints - 1 && IsEndAnchorBound());
+		if (bAnchor || Point < 0 || Point >= NumPoints) continue;
+
+		if (bParticles)
+		{
+			Subsystem->GetSolver().SetParticlePinned(ParticleChainId, Point, false);
+		}
+		else if (LinkComponents[Point])
+		{
+			LinkComponents[Point]->SetSimulatePhysics(true);
+		}
+	}
+
+	PinnedKeyPoints.Reset();
+	for (int32 Key = 0; Key < NumKeys; ++Key)
+	{
+		const int32 Point = GetKeyPointIndex(Key, NumKeys, NumPoints);
+		PinnedKeyPoints.Add(Point);
+
+		if (bParticles)
+		{
+			Subsystem->GetSolver().SetParticlePinned(ParticleChainId, Point, true);
+		}
+		else if (LinkComponents[Point])
+		{
+			LinkComponents[Point]->SetSimulatePhysics(false);
+		}
+	}
+	PinnedKeyPointCount = NumPoints;
+}
+
+void AChainInstanceActor::InitializeFromProfile()
+{
+	if (!Profile) return;
+
+	RebuildChain();
+}
+
+void AChainInstanceActor::RebuildChain()
+{
+	if (!Profile)
+	{
+		ClearChain();
+		return;
+	}
+
+	// Existing components are reused, the build only adds or removes the delta
+	ReleaseParticleChain();
+	BeginBuild();
+
+	UChainSimulationSubsystem* Subsystem = GetSimulationSubsystem();
+	if (Subsystem && ShouldBuildAsync())
+	{
+		bBuildPending = true;
+		UpdateBuildProxy();
+		Subsystem->QueueChainBuild(this);
+		return;
+	}
+
+	ContinueBuild(TNumericLimits<double>::Max());
+	OnChainReady.Broadcast(this);
+}
+
+bool AChainInstanceActor::ShouldBuildAsync() const
+{
+	const UWorld* World = GetWorld();
+	if (!bAsyncBuild || !World || !World->IsGameWorld()) return false;
+
+	// Only components are worth spreading, registering particles is cheap
+	return UsesLinkComponents() || !UsesParticleSolver();
+}
+
+void AChainInstanceActor::ClearChain()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(AChainInstanceActor::ClearChain);
+
+	bBuildPending = false;
+	UpdateBuildProxy();
+
+	for (UStaticMeshComponent* Comp : LinkComponents)
+	{
+		if (Comp) Comp->DestroyComponent();
+	}
+	LinkComponents.Empty();
+
+	for (UPhysicsConstraintComponent* Const : ConstraintComponents)
+	{
+		if (Const) Const->DestroyComponent();
+	}
+	ConstraintComponents.Empty();
+
+	for (UStaticMeshComponent* Comp : LinkPool)
+	{
+		if (Comp) Comp->DestroyComponent();
+	}
+	LinkPool.Empty();
+	LinkTemplateSerials.Empty();
+
+	for (UPhysicsConstraintComponent* Const : ConstraintPool)
+	{
+		if (Const) Const->DestroyComponent();
+	}
+	ConstraintPool.Empty();
+
+	if (TubeMesh)
+	{
+		TubeMesh->DestroyComponent();
+		TubeMesh = nullptr;
+	}
+	TubeBuffers.Reset();
+
+	LinkTransforms.Empty();
+	ReleaseParticleChain();
+}
+
+void AChainInstanceActor::BeginBuild()
+{
+	INC_DWORD_STAT(STAT_ChainRebuilds);
+
+	// Segment count of the current LOD level (profile default until the first LOD evaluation)
+	CurrentSegmentCount = Profile->GetSegmentCountForLOD(CurrentLODIndex);
+
+	// A rebuild starts back from the authored length
+	CurrentLength = Profile->GetBaseLength();
+	TargetLength = CurrentLength;
+
+	NumBuiltLinks = 0;
+	NumBuiltConstraints = 0;
+}
+
+bool AChainInstanceActor::ContinueBuild(double Deadline)
+{
+	if (!Profile) return true;
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(AChainInstanceActor::ContinueBuild);
+	SCOPE_CYCLE_COUNTER(STAT_ChainBuild);
+
+	// Links kept from a previous build get the profile re-applied in place, new ones come configured from the pool.
+	// Instanced and tube chains have no link component at all. One link per step, checking the deadline after each.
+	const int32 NumLinkComponents = UsesLinkComponents() ? CurrentSegmentCount : 0;
+	while (NumBuiltLinks < NumLinkComponents)
+	{
+		UStaticMeshComponent* Link = nullptr;
+		if (LinkComponents.IsValidIndex(NumBuiltLinks))
+		{
+			Link = LinkComponents[NumBuiltLinks];
+			ApplyProfileToLink(Link);
+		}
+		else
+		{
+			Link = LinkComponents.Add_GetRef(AcquireLinkComponent());
+		}
+
+		// Links built ahead of the others wait hidden and kinematic, the finished chain turns them on
+		if (bBuildPending)
+		{
+			Link->SetSimulatePhysics(false);
+			Link->SetVisibility(false);
+		}
+
+		++NumBuiltLinks;
+		if (FPlatformTime::Seconds() >= Deadline) return false;
+	}
+	ResizeLinkComponents(NumLinkComponents);
+
+	// Constraints between consecutive links; the particle backend replaces the joints
+	const int32 NumConstraints = UsesParticleSolver() ? 0 : CurrentSegmentCount - 1;
+	while (NumBuiltConstraints < NumConstraints)
+	{
+		if (ConstraintComponents.IsValidIndex(NumBuiltConstraints))
+		{
+			BindConstraint(NumBuiltConstraints);
+			ApplyProfileToConstraint(ConstraintComponents[NumBuiltConstraints]);
+		}
+		else
+		{
+			ResizeConstraintComponents(NumBuiltConstraints + 1);
+		}
+
+		++NumBuiltConstraints;
+		if (FPlatformTime::Seconds() >= Deadline) return false;
+	}
+	ResizeConstraintComponents(NumConstraints);
+
+	FinishBuild();
+	return true;
+}
+
+void AChainInstanceActor::FinishBuild()
+{
+	SetupTubeMesh();
+
+	if (UsesParticleSolver())
+	{
+		LinkTransforms.Reset();
+		InitializeParticleSolver();
+	}
+
+	if (bBuildPending)
+	{
+		bBuildPending = false;
+		UpdateBuildProxy();
+
+		for (UStaticMeshComponent* Link : LinkComponents)
+		{
+			Link->SetVisibility(true);
+		}
+	}
+
+	// LOD state first, simulating a link afterwards would detach the one BindAnchors attached
+	ApplyLODSimulationState();
+	BindAnchors();
+}
+
+void AChainInstanceActor::UpdateBuildProxy()
+{
+	if (!bBuildPending)
+	{
+		if (BuildProxy)
+		{
+			BuildProxy->DestroyComponent();
+			BuildProxy = nullptr;
+		}
+		return;
+	}
+
+	if (!BuildProxy)
+	{
+		BuildProxy = NewObject<UProceduralMeshComponent>(this, MakeUniqueObjectName(this, UProceduralMeshComponent::StaticClass(), TEXT("BuildProxy")));
+		BuildProxy->SetupAttachment(RootComponent);
+		BuildProxy->RegisterComponent();
+		BuildProxy->SetUsingAbsoluteLocation(true);
+		BuildProxy->SetUsingAbsoluteRotation(true);
+		BuildProxy->SetUsingAbsoluteScale(true);
+		BuildProxy->SetWorldTransform(FTransform::Identity);
+		BuildProxy->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	}
+
+	// The pose the particles will start from: baked rest pose or straight line, drawn as a plain tube
+	TArray<FVector> Pose;
+	MakeInitialPose(Pose);
+
+	const FChainVisualSettings& Vis = Profile->Visual;
+	FChainTubeMesh ProxyBuffers;
+	ProxyBuffers.Build(Pose, Vis.TubeRadius, Vis.TubeRadialSegments, 1);
+
+	static const TArray<FColor> NoColors;
+	BuildProxy->CreateMeshSection(0, ProxyBuffers.Vertices, ProxyBuffers.Triangles, ProxyBuffers.Normals, ProxyBuffers.UVs, NoColors, ProxyBuffers.Tangents, false);
+	BuildProxy->SetMaterial(0, Vis.TubeMaterial);
+}
+
+void AChainInstanceActor::ResizeLinkComponents(int32 NumLinks)
+{
+	while (LinkComponents.Num() > NumLinks)
+	{
+		ReleaseLinkComponent(LinkComponents.Pop());
+	}
+	while (LinkComponents.Num() < NumLinks)
+	{
+		LinkComponents.Add(AcquireLinkComponent());
+	}
+}
+
+void AChainInstanceActor::ResizeConstraintComponents(int32 NumConstraints)
+{
+	NumConstraints = FMath::Max(0, NumConstraints);
+
+	while (ConstraintComponents.Num() > NumConstraints)
+	{
+		ReleaseConstraintComponent(ConstraintComponents.Pop());
+	}
+	while (ConstraintComponents.Num() < NumConstraints)
+	{
+		ConstraintComponents.Add(AcquireConstraintComponent());
+		BindConstraint(ConstraintComponents.Num() - 1);
+	}
+}
+
+UStaticMeshComponent* AChainInstanceActor::AcquireLinkComponent()
+{
+	UStaticMeshComponent* Link = nullptr;
+	while (!Link && LinkPool.Num() > 0)
+	{
+		Link = LinkPool.Pop();
+	}
+
+	if (!Link)
+	{
+		Link = NewObject<UStaticMeshComponent>(this, MakeUniqueObjectName(this, UStaticMeshComponent::StaticClass(), TEXT("Link")));
+		Link->SetupAttachment(RootComponent);
+		Link->RegisterComponent();
+	}
+
+	ApplyProfileToLink(Link);
+	return Link;
+}
+
+void AChainInstanceActor::ReleaseLinkComponent(UStaticMeshComponent* Link)
+{
+	if (!Link) return;
+
+	// Pooled links stay registered but cost nothing: hidden, not simulating, no collision.
+	Link->SetSimulatePhysics(false);
+	Link->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Link->SetVisibility(false);
+	LinkPool.Add(Link);
+}
+
+UPhysicsConstraintComponent* AChainInstanceActor::AcquireConstraintComponent()
+{
+	UPhysicsConstraintComponent* Constraint = nullptr;
+	while (!Constraint && ConstraintPool.Num() > 0)
+	{
+		Constraint = ConstraintPool.Pop();
+	}
+
+	if (!Constraint)
+	{
+		Constraint = NewObject<UPhysicsConstraintComponent>(this, MakeUniqueObjectName(this, UPhysicsConstraintComponent::StaticClass(), TEXT("Constraint")));
+		Constraint->SetupAttachment(RootComponent);
+		Constraint->RegisterComponent();
+	}
+
+	ApplyProfileToConstraint(Constraint);
+	return Constraint;
+}
+
+void AChainInstanceActor::ReleaseConstraintComponent(UPhysicsConstraintComponent* Constraint)
+{
+	if (!Constraint) return;
+
+	// Releases the physics joint, SetConstrainedComponents re-creates it when reused.
+	Constraint->BreakConstraint();
+	ConstraintPool.Add(Constraint);
+}
+
+void AChainInstanceActor::SetupTubeMesh()
+{
+	if (!UsesTubeMesh())
+	{
+		if (TubeMesh)
+		{
+			TubeMesh->DestroyComponent();
+			TubeMesh = nullptr;
+		}
+		TubeBuffers.Reset();
+		return;
+	}
+
+	if (!TubeMesh)
+	{
+		TubeMesh = NewObject<UProceduralMeshComponent>(this, MakeUniqueObjectName(this, UProceduralMeshComponent::StaticClass(), TEXT("Tube")));
+		TubeMesh->SetupAttachment(RootComponent);
+		TubeMesh->RegisterComponent();
+	}
+
+	// Vertices are written in world space, straight from the particles
+	TubeMesh->SetUsingAbsoluteLocation(true);
+	TubeMesh->SetUsingAbsoluteRotation(true);
+	TubeMesh->SetUsingAbsoluteScale(true);
+	TubeMesh->SetWorldTransform(FTransform::Identity);
+	TubeMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	TubeMesh->bUseAsyncCooking = true;
+
+	// Force a section re-creation with the current settings
+	TubeMesh->ClearAllMeshSections();
+	TubeBuffers.Reset();
+}
+
+void AChainInstanceActor::UpdateTubeMesh()
+{
+	UChainSimulationSubsystem* Subsystem = GetSimulationSubsystem();
+	if (!TubeMesh || !Subsystem || ParticleChainId == INDEX_NONE) return;
+
+	const FChainVisualSettings& Vis = Profile->Visual;
+	Subsystem->GetSolver().GetParticlePositions(ParticleChainId, TubePoints);
+
+	static const TArray<FColor> NoColors;
+	if (TubeBuffers.Build(TubePoints, Vis.TubeRadius, Vis.TubeRadialSegments, Vis.TubeSubdivisions))
+	{
+		TubeMesh->CreateMeshSection(0, TubeBuffers.Vertices, TubeBuffers.Triangles, TubeBuffers.Normals, TubeBuffers.UVs, NoColors, TubeBuffers.Tangents, false);
+		TubeMesh->SetMaterial(0, Vis.TubeMaterial);
+	}
+	else
+	{
+		TubeMesh->UpdateMeshSection(0, TubeBuffers.Vertices, TubeBuffers.Normals, TubeBuffers.UVs, NoColors, TubeBuffers.Tangents);
+	}
+}
+
+void AChainInstanceActor::BindConstraint(int32 Index)
+{
+	ConstraintComponents[Index]->SetConstrainedComponents(
+		LinkComponents[Index],
+		NAME_None,
+		LinkComponents[Index + 1],
+		NAME_None
+	);
+}
+
+void AChainInstanceActor::ApplyProfileToLink(UStaticMeshComponent* Link)
+{
+	if (!Link || !Profile) return;
+
+	const FChainCompiledTemplate& Template = Profile->GetCompiledTemplate();
+	const FChainVisualSettings& Vis = Profile->Visual;
+
+	// Particle links get world space transforms written from the solver every frame.
+	const bool bParticleLink = UsesParticleSolver();
+	Link->SetUsingAbsoluteLocation(bParticleLink);
+	Link->SetUsingAbsoluteRotation(bParticleLink);
+
+	// Reused links may still be attached to an old anchor; the relative transform is against the chain root.
+	if (Link->GetAttachParent() != RootComponent)
+	{
+		Link->AttachToComponent(RootComponent, FAttachmentTransformRules::KeepRelativeTransform);
+	}
+
+	// The compiled body is only copied into links that do not have it yet, with no physics state while copying.
+	// Links already built from this template keep their live body; the LOD state updates it in place.
+	uint32& LinkTemplateSerial = LinkTemplateSerials.FindOrAdd(Link);
+	const bool bCopyBody = LinkTemplateSerial != Template.Serial || !Link->IsPhysicsStateCreated();
+	if (bCopyBody)
+	{
+		Link->DestroyPhysicsState();
+		Link->BodyInstance.CopyBodyInstancePropertiesFrom(bParticleLink ? &Template.RenderLinkBody : &Template.SimulatedLinkBody);
+		LinkTemplateSerial = Template.Serial;
+	}
+	Link->SetStaticMesh(Vis.LinkMesh);
+	Link->SetRelativeTransform(Vis.LinkRelativeTransform);
+	if (!Link->IsPhysicsStateCreated())
+	{
+		Link->RecreatePhysicsState();
+	}
+
+	// Simulated bodies leave their parent, as SetSimulatePhysics would have done; BindAnchors re-attaches the ends.
+	if (!bParticleLink && Link->GetAttachParent())
+	{
+		Link->DetachFromComponent(FDetachmentTransformRules::KeepWorldTransform);
+	}
+
+	Link->SetVisibility(true);
+}
+
+void AChainInstanceActor::ApplyLinkCollision(UStaticMeshComponent* Link, bool bEnableCollision)
+{
+	// Disabled keeps the body simulating but lets it pass through everything
+	const FChainCompiledTemplate& Template = Profile->GetCompiledTemplate();
+	const FChainLinkCollisionSetup& Collision = bEnableCollision ? Template.LinkCollision : Template.IgnoredLinkCollision;
+
+	// Each setter updates the body, links already set up are left alone
+	if (Link->GetCollisionObjectType() != Collision.ObjectType)
+	{
+		Link->SetCollisionObjectType(Collision.ObjectType);
+	}
+	if (Link->GetCollisionResponseToChannels() != Collision.Responses)
+	{
+		Link->SetCollisionResponseToChannels(Collision.Responses);
+	}
+	Link->SetCollisionEnabled(Collision.CollisionEnabled);
+}
+
+void AChainInstanceActor::ApplyProfileToConstraint(UPhysicsConstraintComponent* Constraint)
+{
+	if (!Constraint || !Profile) return;
+
+	// Limits, drives and break thresholds in one copy, applied to the joint if it already exists
+	Constraint->ConstraintInstance.CopyProfilePropertiesFrom(Profile->GetCompiledTemplate().ConstraintProfile);
+}
+
+void AChainInstanceActor::BindAnchors()
+{
+	if (!HasBuiltChain()) return;
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(AChainInstanceActor::BindAnchors);
+
+	if (UsesParticleSolver())
+	{
+		// Anchors pin the first / last particle instead of attaching link components.
+		UChainSimulationSubsystem* Subsystem = GetSimulationSubsystem();
+		if (!Subsystem || ParticleChainId == INDEX_NONE) return;
+
+		FChainXPBDSolver& Solver = Subsystem->GetSolver();
+		const int32 LastParticle = Solver.GetNumParticles(ParticleChainId) - 1;
+		Solver.SetParticlePinned(ParticleChainId, 0, IsStartAnchorBound());
+		Solver.SetParticlePinned(ParticleChainId, LastParticle, IsEndAnchorBound());
+		return;
+	}
+
+	// Anchor link 0
+	{
+		if (StartAnchor.bUseWorldLocation)
+		{
+			LinkComponents[0]->SetWorldLocation(StartAnchor.WorldLocation);
+		}
+		else if (StartAnchor.Component)
+		{
+			LinkComponents[0]->AttachToComponent(StartAnchor.Component,
+				FAttachmentTransformRules::SnapToTargetIncludingScale,
+				StartAnchor.SocketName);
+		}
+	}
+
+	// Anchor last link
+	if (Profile->bSupportsLooseEnd == false && LinkComponents.IsValidIndex(LinkComponents.Num() - 1))
+	{
+		if (!EndAnchor.bUseWorldLocation && EndAnchor.Component)
+		{
+			LinkComponents.Last()->AttachToComponent(EndAnchor.Component,
+				FAttachmentTransformRules::KeepWorldTransform,
+				EndAnchor.SocketName);
+		}
+		else if (EndAnchor.bUseWorldLocation)
+		{
+			LinkComponents.Last()->SetWorldLocation(EndAnchor.WorldLocation);
+		}
+	}
+}
+
+void AChainInstanceActor::InitializeParticleSolver()
+{
+	TArray<FVector> Positions;
+	const bool bSettled = MakeInitialPose(Positions);
 
-	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+	RegisterParticleChain(Positions);
+	ApplyParticlesToLinks();
+
+	// A chain spawned at rest can sleep right away instead of waiting SleepFrames
+	if (bSettled && ParticleChainId != INDEX_NONE && Profile->Sleep.bAllowSleep && !IsReplicatedPoseClient())
+	{
+		LastStartAnchorLocation = Positions[0];
+		LastEndAnchorLocation = Positions.Last();
+		bAnchorsStill = true;
+		PutToSleep();
+	}
 }
 
-void AChainInstanceActor::BeginPlay()
+bool AChainInstanceActor::MakeInitialPose(TArray<FVector>& OutPositions) const
 {
-	Super::BeginPlay();
+	const FVector Start = IsStartAnchorBound() ? ResolveAnchorLocation(StartAnchor) : GetActorLocation();
+	if (IsEndAnchorBound() && LayoutFromRestPose(Start, ResolveAnchorLocation(EndAnchor), OutPositions))
+	{
+		return true;
+	}
 
-	if (HasAuthority())
+	// Lay the particles out on a straight line from the start anchor, towards the end anchor or hanging down.
+	FVector Direction = -FVector::UpVector;
+	if (IsEndAnchorBound())
 	{
-		InitializeFromProfile();
+		Direction = (ResolveAnchorLocation(EndAnchor) - Start).GetSafeNormal(UE_SMALL_NUMBER, -FVector::UpVector);
+	}
+
+	const float SegmentLength = CurrentLength / CurrentSegmentCount;
+	OutPositions.SetNumUninitialized(CurrentSegmentCount + 1);
+	for (int32 i = 0; i < OutPositions.Num(); ++i)
+	{
+		OutPositions[i] = Start + Direction * (SegmentLength * i);
 	}
+	return false;
 }
 
-void AChainInstanceActor::OnConstruction(const FTransform& Transform)
+bool AChainInstanceActor::LayoutFromRestPose(const FVector& Start, const FVector& End, TArray<FVector>& OutPositions) const
 {
-	Super::OnConstruction(Transform);
+	if (!Profile->bUseRestPoseCache) return false;
 
-	if (Profile && bAutoRebuild)
+	const FVector Delta = End - Start;
+	const FVector Horizontal(Delta.X, Delta.Y, 0.0);
+	const float Pitch = FMath::Atan2(Delta.Z, Horizontal.Size());
+
+	TArray<FVector2f> Points;
+	if (!Profile->RestPoses.Sample(Delta.Size() / CurrentLength, Pitch, CurrentSegmentCount + 1, Points)) return false;
+
+	// Vertical plane through both anchors; vertical spans keep the actor's facing
+	const FVector Axis = Horizontal.GetSafeNormal(UE_SMALL_NUMBER, GetActorForwardVector().GetSafeNormal2D(UE_SMALL_NUMBER, FVector::ForwardVector));
+
+	OutPositions.SetNumUninitialized(Points.Num());
+	for (int32 i = 0; i < Points.Num(); ++i)
 	{
-		InitializeFromProfile();
+		OutPositions[i] = Start + (Axis * Points[i].X + FVector::UpVector * Points[i].Y) * CurrentLength;
 	}
+
+	// Spread the interpolation error along the chain so both ends land on their anchors
+	const FVector Error = End - OutPositions.Last();
+	for (int32 i = 1; i < OutPositions.Num(); ++i)
+	{
+		OutPositions[i] += Error * (static_cast<float>(i) / (OutPositions.Num() - 1));
+	}
+	return true;
 }
 
-void AChainInstanceActor::InitializeFromProfile()
+void AChainInstanceActor::RegisterParticleChain(TConstArrayView<FVector> Positions)
 {
-	if (!Profile) return;
+	UChainSimulationSubsystem* Subsystem = GetSimulationSubsystem();
+	if (!Subsystem) return;
 
-	RebuildChain();
+	const FChainSimulationSettings& Sim = Profile->Simulation;
+
+	NominalSegmentLength = CurrentLength / CurrentSegmentCount;
+	FirstSegmentLength = NominalSegmentLength;
+
+	// Reserve room for the particles reeling out to the max length will insert, at the densest LOD level
+	int32 MaxSegmentCount = FMath::Max(CurrentSegmentCount, Profile->GetSegmentCountForLOD(INDEX_NONE));
+	for (int32 LODIndex = 0; LODIndex < Profile->LODLevels.Num(); ++LODIndex)
+	{
+		MaxSegmentCount = FMath::Max(MaxSegmentCount, Profile->GetSegmentCountForLOD(LODIndex));
+	}
+	const float MinSegmentLength = FMath::Min(NominalSegmentLength, Profile->GetBaseLength() / MaxSegmentCount);
+
+	FChainSolverChainSettings Settings = MakeSolverChainSettings(*Profile);
+	Settings.MaxParticles = FMath::CeilToInt(Profile->GetMaxLength() / MinSegmentLength) + 2;
+
+	ParticleChainId = Subsystem->RegisterChain(this, Positions, Settings,
+		Profile->GetIterationsForLOD(CurrentLODIndex), Profile->GetSubstepsForLOD(CurrentLODIndex), Sim.MaxDeltaTime, Sim.FixedTimeStep);
+	PinnedKeyPoints.Reset();
+	PinnedKeyPointCount = 0;
+	bIsSleeping = false;
+	StillFrames = 0;
+	Subsystem->GetSolver().SetSegmentRestLength(ParticleChainId, NominalSegmentLength);
+	Subsystem->SetChainCollision(ParticleChainId, MakeWorldCollision(*Profile, CurrentLODIndex));
 }
 
-void AChainInstanceActor::RebuildChain()
+void AChainInstanceActor::ReleaseParticleChain()
 {
-	ClearChain();
-	BuildChain();
-	BindAnchors();
+	if (ParticleChainId == INDEX_NONE) return;
+
+	if (UChainSimulationSubsystem* Subsystem = GetSimulationSubsystem())
+	{
+		Subsystem->UnregisterChain(ParticleChainId);
+	}
+	ParticleChainId = INDEX_NONE;
 }
 
-void AChainInstanceActor::ClearChain()
+void AChainInstanceActor::PushAnchorTargets()
 {
-	for (UStaticMeshComponent* Comp : LinkComponents)
+	UChainSimulationSubsystem* Subsystem = GetSimulationSubsystem();
+	if (!Subsystem || ParticleChainId == INDEX_NONE) return;
+
+	FChainXPBDSolver& Solver = Subsystem->GetSolver();
+
+	// Anchors sweep the pinned particles along with their motion
+	FVector Velocity;
+	if (IsStartAnchorBound())
 	{
-		if (Comp) Comp->DestroyComponent();
+		const FVector Location = ResolveAnchorLocation(StartAnchor, &Velocity);
+		Subsystem->SetAnchorTarget(ParticleChainId, 0, Location, Velocity);
+	}
+	if (IsEndAnchorBound())
+	{
+		const FVector Location = ResolveAnchorLocation(EndAnchor, &Velocity);
+		Subsystem->SetAnchorTarget(ParticleChainId, Solver.GetNumParticles(ParticleChainId) - 1, Location, Velocity);
 	}
-	LinkComponents.Empty();
 
-	for (UPhysicsConstraintComponent* Const : ConstraintComponents)
+	// Clients follow the server keys, anchors stay local
+	if (IsReplicatedPoseClient())
 	{
-		if (Const) Const->DestroyComponent();
+		PinKeyPoints();
+		const int32 NumParticles = Solver.GetNumParticles(ParticleChainId);
+		const int32 NumKeys = ClientKeyTargets.Num();
+		for (int32 Key = 0; Key < NumKeys; ++Key)
+		{
+			const int32 Particle = GetKeyPointIndex(Key, NumKeys, NumParticles);
+			const bool bAnchor = (Particle == 0 && IsStartAnchorBound()) || (Particle == NumParticles - 1 && IsEndAnchorBound());
+			if (!bAnchor)
+			{
+				Solver.SetKinematicTarget(ParticleChainId, Particle, ClientKeyTargets[Key]);
+			}
+		}
 	}
-	ConstraintComponents.Empty();
 }
 
-void AChainInstanceActor::BuildChain()
+void AChainInstanceActor::UpdateReel(float DeltaTime)
 {
-	if (!Profile)
+	if (ParticleChainId == INDEX_NONE || CurrentLength == TargetLength || NominalSegmentLength <= 0.0f) return;
+
+	UChainSimulationSubsystem* Subsystem = GetSimulationSubsystem();
+	if (!Subsystem) return;
+
+	FChainXPBDSolver& Solver = Subsystem->GetSolver();
+
+	// Never more than half a segment per frame, so at most one particle enters or leaves whatever the reel speed.
+	float MaxStep = 0.5f * NominalSegmentLength;
+	if (Profile->ReelSpeed > 0.0f)
+	{
+		MaxStep = FMath::Min(MaxStep, Profile->ReelSpeed * DeltaTime);
+	}
+
+	const float Remaining = TargetLength - CurrentLength;
+	const float Step = FMath::Clamp(Remaining, -MaxStep, MaxStep);
+	float NewFirstLength = FirstSegmentLength + Step;
+
+	if (NewFirstLength > 1.5f * NominalSegmentLength)
+	{
+		// Reel out: split the first segment, the new particle starts on it so nothing snaps
+		if (!Solver.InsertParticleAtStart(ParticleChainId, NewFirstLength - NominalSegmentLength, NominalSegmentLength)) return;
+
+		NewFirstLength -= NominalSegmentLength;
+		LinkTransforms.Insert(LinkTransforms.Num() > 0 ? LinkTransforms[0] : FTransform::Identity, 0);
+		if (UsesLinkComponents())
+		{
+			LinkComponents.Insert(AcquireLinkComponent(), 0);
+		}
+		++CurrentSegmentCount;
+	}
+	else if (NewFirstLength < 0.5f * NominalSegmentLength)
+	{
+		// Reel in: merge the first two segments
+		if (!Solver.RemoveParticleAtStart(ParticleChainId, NewFirstLength + NominalSegmentLength)) return;
+
+		NewFirstLength += NominalSegmentLength;
+		LinkTransforms.RemoveAt(0);
+		if (UsesLinkComponents())
+		{
+			ReleaseLinkComponent(LinkComponents[0]);
+			LinkComponents.RemoveAt(0);
+		}
+		--CurrentSegmentCount;
+	}
+	else
+	{
+		Solver.SetFirstSegmentRestLength(ParticleChainId, NewFirstLength);
+	}
+
+	FirstSegmentLength = NewFirstLength;
+	CurrentLength = FMath::Abs(Remaining) <= MaxStep ? TargetLength : CurrentLength + Step;
+}
+
+void AChainInstanceActor::UpdateSleep(float DeltaTime, bool bCheckOverlap)
+{
+	if (!Profile || !HasBuiltChain()) return;
+
+	if (bIsSleeping)
+	{
+		if (ShouldWake(bCheckOverlap))
+		{
+			WakeUp();
+		}
 		return;
+	}
 
-	CurrentSegmentCount = Profile->Visual.DefaultSegmentCount;
+	if (!Profile->Sleep.bAllowSleep) return;
 
-	// Safety
-	CurrentSegmentCount = FMath::Max(2, CurrentSegmentCount);
+	// Anchors moving faster than the threshold keep the chain awake
+	const float ThresholdSq = FMath::Square(Profile->Sleep.SleepSpeedThreshold * DeltaTime);
+	const FVector StartLocation = IsStartAnchorBound() ? ResolveAnchorLocation(StartAnchor) : FVector::ZeroVector;
+	const FVector EndLocation = IsEndAnchorBound() ? ResolveAnchorLocation(EndAnchor) : FVector::ZeroVector;
+	bAnchorsStill = FVector::DistSquared(StartLocation, LastStartAnchorLocation) <= ThresholdSq
+		&& FVector::DistSquared(EndLocation, LastEndAnchorLocation) <= ThresholdSq;
+	LastStartAnchorLocation = StartLocation;
+	LastEndAnchorLocation = EndLocation;
 
-	// Create N link components
-	for (int32 i = 0; i < CurrentSegmentCount; ++i)
+	// Particle chains are measured after their solve
+	if (UsesParticleSolver()) return;
+
+	const float SpeedThresholdSq = FMath::Square(Profile->Sleep.SleepSpeedThreshold);
+	bool bLinksStill = true;
+	for (const UStaticMeshComponent* Link : LinkComponents)
 	{
-		FName CompName = FName(*FString::Printf(TEXT("Link_%d"), i));
-		UStaticMeshComponent* Link = NewObject<UStaticMeshComponent>(this, CompName);
+		if (Link && Link->IsSimulatingPhysics() && Link->GetPhysicsLinearVelocity().SizeSquared() > SpeedThresholdSq)
+		{
+			bLinksStill = false;
+			break;
+		}
+	}
+	NotifyStillFrame(bAnchorsStill && bLinksStill);
+}
 
-		Link->SetupAttachment(RootComponent);
-		Link->RegisterComponent();
+void AChainInstanceActor::UpdateParticleSleep()
+{
+	if (!Profile || !Profile->Sleep.bAllowSleep || bIsSleeping) return;
 
-		ApplyProfileToLink(Link);
-		LinkComponents.Add(Link);
+	UChainSimulationSubsystem* Subsystem = GetSimulationSubsystem();
+	if (!Subsystem || ParticleChainId == INDEX_NONE) return;
+
+	const bool bParticlesStill = Subsystem->GetSolver().GetMaxSpeedSquared(ParticleChainId) <= FMath::Square(Profile->Sleep.SleepSpeedThreshold);
+	NotifyStillFrame(bAnchorsStill && bParticlesStill && CurrentLength == TargetLength);
+}
+
+void AChainInstanceActor::NotifyStillFrame(bool bStill)
+{
+	StillFrames = bStill ? StillFrames + 1 : 0;
+	if (StillFrames >= Profile->Sleep.SleepFrames)
+	{
+		PutToSleep();
 	}
+}
+
+void AChainInstanceActor::PutToSleep()
+{
+	bIsSleeping = true;
+	StillFrames = 0;
 
-	// Create constraints between consecutive links
-	for (int32 i = 0; i < CurrentSegmentCount - 1; ++i)
+	// Bounds used by the overlap wake check
+	TArray<FVector> Pose;
+	GetChainPose(Pose);
+	SleepBounds = FBox(Pose).ExpandBy(UsesTubeMesh() ? Profile->Visual.TubeRadius : 5.0f);
+
+	for (UStaticMeshComponent* Link : LinkComponents)
 	{
-		FName CName = FName(*FString::Printf(TEXT("Constraint_%d"), i));
+		if (Link && Link->IsSimulatingPhysics())
+		{
+			Link->PutRigidBodyToSleep();
+		}
+	}
+}
 
-		UPhysicsConstraintComponent* Constraint = NewObject<UPhysicsConstraintComponent>(this, CName);
-		Constraint->SetupAttachment(RootComponent);
-		Constraint->RegisterComponent();
+void AChainInstanceActor::WakeUp()
+{
+	if (!bIsSleeping) return;
 
-		Constraint->SetConstrainedComponents(
-			LinkComponents[i],
-			NAME_None,
-			LinkComponents[i + 1],
-			NAME_None
-		);
+	bIsSleeping = false;
+	StillFrames = 0;
 
-		ApplyProfileToConstraint(Constraint);
-		ConstraintComponents.Add(Constraint);
+	for (UStaticMeshComponent* Link : LinkComponents)
+	{
+		if (Link && Link->IsSimulatingPhysics())
+		{
+			Link->WakeRigidBody();
+		}
 	}
 }
 
-void AChainInstanceActor::ApplyProfileToLink(UStaticMeshComponent* Link)
+bool AChainInstanceActor::ShouldWake(bool bCheckOverlap) const
 {
-	if (!Link || !Profile) return;
+	const float ToleranceSq = FMath::Square(ChainWakeAnchorTolerance);
+	if (IsStartAnchorBound() && FVector::DistSquared(ResolveAnchorLocation(StartAnchor), LastStartAnchorLocation) > ToleranceSq) return true;
+	if (IsEndAnchorBound() && FVector::DistSquared(ResolveAnchorLocation(EndAnchor), LastEndAnchorLocation) > ToleranceSq) return true;
 
-	const FChainLinkPhysicsSettings& Phys = Profile->Physics;
-	const FChainVisualSettings& Vis = Profile->Visual;
+	if (!bCheckOverlap) return false;
 
-	Link->SetStaticMesh(Vis.LinkMesh);
-	Link->SetRelativeTransform(Vis.LinkRelativeTransform);
+	// Chaos wakes rigid links by itself on contact
+	for (const UStaticMeshComponent* Link : LinkComponents)
+	{
+		if (Link && Link->IsSimulatingPhysics() && Link->RigidBodyIsAwake()) return true;
+	}
+
+	if (!Profile->Sleep.bWakeOnOverlap || !SleepBounds.IsValid) return false;
+
+	// Moving things entering the chain bounds; the anchor owners are expected to touch it
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ChainWakeOverlap), false, this);
+	if (StartAnchor.Component) QueryParams.AddIgnoredActor(StartAnchor.Component->GetOwner());
+	if (EndAnchor.Component) QueryParams.AddIgnoredActor(EndAnchor.Component->GetOwner());
+
+	FCollisionObjectQueryParams ObjectParams;
+	ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
+	ObjectParams.AddObjectTypesToQuery(ECC_PhysicsBody);
+	ObjectParams.AddObjectTypesToQuery(ECC_Vehicle);
+
+	return GetWorld()->OverlapAnyTestByObjectType(SleepBounds.GetCenter(), FQuat::Identity, ObjectParams, FCollisionShape::MakeBox(SleepBounds.GetExtent()), QueryParams);
+}
+
+void AChainInstanceActor::AddImpulseAtLocation(const FVector& Impulse, const FVector& Location, float Radius)
+{
+	if (!Profile || !HasBuiltChain()) return;
 
-	Link->SetSimulatePhysics(true);
-	Link->SetMassOverrideInKg(NAME_None, Phys.LinkMass, true);
-	Link->SetLinearDamping(Phys.LinearDamping);
-	Link->SetAngularDamping(Phys.AngularDamping);
+	WakeUp();
 
-	if (Phys.CollisionProfileName != NAME_None)
+	if (UsesParticleSolver())
 	{
-		Link->SetCollisionProfileName(Phys.CollisionProfileName);
+		UChainSimulationSubsystem* Subsystem = GetSimulationSubsystem();
+		if (Subsystem && ParticleChainId != INDEX_NONE)
+		{
+			Subsystem->GetSolver().AddVelocity(ParticleChainId, Location, Radius, Impulse / FMath::Max(Profile->Physics.LinkMass, UE_KINDA_SMALL_NUMBER));
+		}
+		return;
 	}
-	else
+
+	const float RadiusSq = FMath::Square(Radius);
+	for (UStaticMeshComponent* Link : LinkComponents)
 	{
-		Link->SetCollisionObjectType(Phys.CollisionChannel);
+		if (Link && Link->IsSimulatingPhysics() && FVector::DistSquared(Link->GetComponentLocation(), Location) <= RadiusSq)
+		{
+			Link->AddImpulse(Impulse);
+		}
 	}
+}
 
-	Link->SetNotifyRigidBodyCollision(true);
-	Link->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-	Link->SetVisibility(true);
+void AChainInstanceActor::ApplyParticlesToLinks()
+{
+	UChainSimulationSubsystem* Subsystem = GetSimulationSubsystem();
+	if (!Subsystem || ParticleChainId == INDEX_NONE) return;
+
+	const FChainXPBDSolver& Solver = Subsystem->GetSolver();
+	LinkTransforms.SetNum(Solver.GetNumParticles(ParticleChainId) - 1);
+	WriteLinkTransforms(Solver, ParticleChainId, Profile->Visual.LinkRelativeTransform, LinkTransforms);
+
+	// Instanced chains are gathered in bulk by the subsystem
+	const int32 NumLinkComponents = FMath::Min(LinkComponents.Num(), LinkTransforms.Num());
+	for (int32 i = 0; i < NumLinkComponents; ++i)
+	{
+		if (LinkComponents[i])
+		{
+			LinkComponents[i]->SetWorldLocationAndRotation(LinkTransforms[i].GetLocation(), LinkTransforms[i].GetRotation(), false, nullptr, ETeleportType::TeleportPhysics);
+		}
+	}
+
+	if (TubeMesh)
+	{
+		UpdateTubeMesh();
+	}
 }
 
-void AChainInstanceActor::ApplyProfileToConstraint(UPhysicsConstraintComponent* Constraint)
+void AChainInstanceActor::WriteLinkTransforms(const FChainXPBDSolver& Solver, int32 ChainId, const FTransform& LinkRelative, TArrayView<FTransform> LinkTransforms)
 {
-	if (!Constraint || !Profile) return;
+	for (int32 i = 0; i < LinkTransforms.Num(); ++i)
+	{
+		const FVector A = Solver.GetParticlePosition(ChainId, i);
+		const FVector B = Solver.GetParticlePosition(ChainId, i + 1);
+
+		// Rotate the previous orientation onto the new segment so links do not flip around their axis.
+		const FQuat PrevRotation = LinkTransforms[i].GetRotation() * LinkRelative.GetRotation().Inverse();
+		const FVector Axis = (B - A).GetSafeNormal(UE_SMALL_NUMBER, PrevRotation.GetAxisX());
+		const FQuat Rotation = FQuat::FindBetweenNormals(PrevRotation.GetAxisX(), Axis) * PrevRotation;
+
+		LinkTransforms[i] = LinkRelative * FTransform(Rotation, (A + B) * 0.5f);
+	}
+}
+
+UChainSimulationSubsystem* AChainInstanceActor::GetSimulationSubsystem() const
+{
+	const UWorld* World = GetWorld();
+	return World ? World->GetSubsystem<UChainSimulationSubsystem>() : nullptr;
+}
+
+FChainSolverChainSettings AChainInstanceActor::MakeSolverChainSettings(const UChainProfile& InProfile)
+{
+	const FChainSimulationSettings& Sim = InProfile.Simulation;
 
-	const FChainConstraintSettings& C = Profile->Constraint;
+	FChainSolverChainSettings Settings;
+	Settings.ParticleMass = InProfile.Physics.LinkMass;
+	Settings.DistanceCompliance = Sim.DistanceCompliance;
+	Settings.bEnableBending = Sim.bEnableBendConstraints;
+	Settings.BendCompliance = Sim.BendCompliance;
+	Settings.Damping = InProfile.Physics.LinearDamping;
+	Settings.GravityScale = Sim.GravityScale;
+	Settings.bEnableTethers = Sim.bEnableTethers;
+	Settings.TetherStretch = Sim.TetherStretch;
+	Settings.bEnableSelfCollision = InProfile.Physics.bEnableSelfCollision;
+	Settings.CollisionRadius = Sim.CollisionRadius;
+	return Settings;
+}
+
+FChainWorldCollision AChainInstanceActor::MakeWorldCollision(const UChainProfile& InProfile, int32 LODIndex)
+{
+	const FChainSimulationSettings& Sim = InProfile.Simulation;
+	const FChainLODLevel* LOD = InProfile.LODLevels.IsValidIndex(LODIndex) ? &InProfile.LODLevels[LODIndex] : nullptr;
+
+	FChainWorldCollision Collision;
+	Collision.bEnabled = Sim.bEnableWorldCollision && (!LOD || LOD->bEnableCollisions);
+	Collision.Radius = Sim.CollisionRadius;
+	Collision.Friction = Sim.CollisionFriction;
+	Collision.Channel = InProfile.Physics.CollisionChannel;
+	Collision.bNotifyHits = InProfile.Physics.bNotifyRigidBodyCollision;
+	Collision.bCollideWithChains = Sim.bCollideWithOtherChains && (!LOD || LOD->bEnableCollisions);
+	return Collision;
+}
+
+bool AChainInstanceActor::IsStartAnchorBound() const
+{
+	return StartAnchor.bUseWorldLocation || StartAnchor.Component != nullptr;
+}
 
-	// Angular
-	Constraint->SetAngularSwing1Limit(C.bEnableSwing ? ACM_Limited : ACM_Free, C.MaxSwingAngle);
-	Constraint->SetAngularSwing2Limit(C.bEnableSwing ? ACM_Limited : ACM_Free, C.MaxSwingAngle);
-	Constraint->SetAngularTwistLimit(C.bEnableTwist ? ACM_Limited : ACM_Free, C.MaxTwistAngle);
+bool AChainInstanceActor::IsEndAnchorBound() const
+{
+	if (!Profile || Profile->bSupportsLooseEnd) return false;
+
+	return EndAnchor.bUseWorldLocation || EndAnchor.Component != nullptr;
+}
 
-	// Linear
-	if (C.LinearLimit > 0)
+FVector AChainInstanceActor::ResolveAnchorLocation(const FChainAnchor& Anchor, FVector* OutVelocity) const
+{
+	if (OutVelocity)
 	{
-		Constraint->SetLinearXLimit(ACM_Limited, C.LinearLimit);
-		Constraint->SetLinearYLimit(ACM_Limited, C.LinearLimit);
-		Constraint->SetLinearZLimit(ACM_Limited, C.LinearLimit);
+		*OutVelocity = FVector::ZeroVector;
 	}
-	else
+	if (Anchor.bUseWorldLocation || !Anchor.Component)
 	{
-		Constraint->SetLinearXLimit(ACM_Free, 0.f);
-		Constraint->SetLinearYLimit(ACM_Free, 0.f);
-		Constraint->SetLinearZLimit(ACM_Free, 0.f);
+		return Anchor.WorldLocation;
 	}
 
-	// Stiffness
-	Constraint->SetLinearDriveParams(C.LinearStiffness, 0.f, 0.f);
-	Constraint->SetAngularDriveParams(C.AngularStiffness, 0.f, 0.f);
+	// Chains sharing a component / socket evaluate it once per frame
+	UChainSimulationSubsystem* Subsystem = GetSimulationSubsystem();
+	return Subsystem ? Subsystem->GetAnchorTracker().Resolve(Anchor.Component, Anchor.SocketName, OutVelocity) : Anchor.ResolveLocation();
+}
+
+void AChainInstanceActor::SetLODLevel(int32 LODIndex)
+{
+	if (!Profile || !Profile->LODLevels.IsValidIndex(LODIndex) || LODIndex == CurrentLODIndex) return;
+
+	CurrentLODIndex = LODIndex;
 
-	// Breaking
-	Constraint->ConstraintInstance.ProfileInstance.LinearBreakThreshold = C.BreakForce;
-	Constraint->ConstraintInstance.ProfileInstance.AngularBreakThreshold = C.BreakTorque;
+	// Reeled chains keep the level's segment density rather than its segment count
+	const float LengthScale = CurrentLength > 0.0f ? CurrentLength / Profile->GetBaseLength() : 1.0f;
+	SetSegmentCount(FMath::RoundToInt(Profile->GetSegmentCountForLOD(LODIndex) * LengthScale));
+	ApplyLODSimulationState();
 }
 
-void AChainInstanceActor::BindAnchors()
+void AChainInstanceActor::SetSegmentCount(int32 NewSegmentCount)
 {
-	if (LinkComponents.Num() == 0) return;
+	NewSegmentCount = FMath::Max(2, NewSegmentCount);
+	if (!Profile || !HasBuiltChain() || NewSegmentCount == CurrentSegmentCount) return;
 
-	// Anchor link 0
+	if (UsesParticleSolver())
 	{
-		if (StartAnchor.bUseWorldLocation)
+		ResizeParticleChain(NewSegmentCount);
+		return;
+	}
+
+	// Current pose, re-sampled onto the new segment count
+	TArray<FVector> Pose;
+	GetChainPose(Pose);
+
+	TArray<FVector> NewPose;
+	ResamplePolyline(Pose, NewSegmentCount, NewPose);
+
+	CurrentSegmentCount = NewSegmentCount;
+
+	// Client key pins no longer match the resampled links: the old ones simulate again,
+	// the next PinKeyPoints lays them out over the new links
+	for (const int32 Point : PinnedKeyPoints)
+	{
+		const bool bAnchor = (Point == 0 && IsStartAnchorBound()) || (Point == LinkComponents.Num() - 1 && IsEndAnchorBound());
+		if (!bAnchor && LinkComponents.IsValidIndex(Point) && LinkComponents[Point])
 		{
-			LinkComponents[0]->SetWorldLocation(StartAnchor.WorldLocation);
+			LinkComponents[Point]->SetSimulatePhysics(true);
 		}
-		else if (StartAnchor.Component)
+	}
+	PinnedKeyPoints.Reset();
+	PinnedKeyPointCount = 0;
+
+	// Only move the link delta in or out of the pool
+	ResizeLinkComponents(UsesLinkComponents() ? NewSegmentCount : 0);
+
+	// Rigid bodies: teleport links onto the new pose, then re-bind the joints
+	for (int32 i = 0; i < NewSegmentCount; ++i)
+	{
+		LinkComponents[i]->SetWorldLocation(NewPose[i], false, nullptr, ETeleportType::ResetPhysics);
+	}
+
+	const int32 NumKeptConstraints = FMath::Min(ConstraintComponents.Num(), NewSegmentCount - 1);
+	ResizeConstraintComponents(NewSegmentCount - 1);
+	for (int32 i = 0; i < NumKeptConstraints; ++i)
+	{
+		BindConstraint(i);
+	}
+
+	BindAnchors();
+}
+
+void AChainInstanceActor::ResizeParticleChain(int32 NewSegmentCount)
+{
+	UChainSimulationSubsystem* Subsystem = GetSimulationSubsystem();
+	if (!Subsystem || ParticleChainId == INDEX_NONE) return;
+
+	FChainXPBDSolver& Solver = Subsystem->GetSolver();
+
+	// Current state, positions and velocities re-sampled onto the new particle count
+	TArray<FVector3f> Positions;
+	TArray<FVector3f> Velocities;
+	Solver.GetParticleState(ParticleChainId, Positions, Velocities);
+
+	TArray<FVector> Pose;
+	Pose.Reserve(Positions.Num());
+	for (const FVector3f& Position : Positions)
+	{
+		Pose.Add(FVector(Position));
+	}
+
+	TArray<FVector> NewPose;
+	TArray<FVector3f> NewVelocities;
+	ResamplePolyline(Pose, NewSegmentCount + 1, NewPose, Velocities, &NewVelocities);
+
+	CurrentSegmentCount = NewSegmentCount;
+	NominalSegmentLength = CurrentLength / CurrentSegmentCount;
+	FirstSegmentLength = NominalSegmentLength;
+	ResizeLinkComponents(UsesLinkComponents() ? NewSegmentCount : 0);
+
+	// The chain keeps its solver range, anchors and stepping; a range too small for the new count is reallocated
+	TArray<FVector3f> NewPositions;
+	NewPositions.Reserve(NewPose.Num());
+	for (const FVector& Position : NewPose)
+	{
+		NewPositions.Add(FVector3f(Position));
+	}
+
+	if (!Solver.ResizeChain(ParticleChainId, NewPositions, NewVelocities, NominalSegmentLength))
+	{
+		ReleaseParticleChain();
+		RegisterParticleChain(NewPose);
+		BindAnchors();
+		ApplyLODSimulationState();
+		Solver.SetParticleState(ParticleChainId, NewPositions, NewVelocities);
+	}
+
+	// Client key pins are laid out again over the new particles by the next PushAnchorTargets
+	PinnedKeyPoints.Reset();
+	PinnedKeyPointCount = 0;
+
+	ApplyParticlesToLinks();
+}
+
+void AChainInstanceActor::ApplyLODSimulationState()
+{
+	// Links of a pending build stay parked, FinishBuild applies the state of the level current by then
+	if (!Profile || bBuildPending) return;
+
+	const FChainLODLevel* LOD = Profile->LODLevels.IsValidIndex(CurrentLODIndex) ? &Profile->LODLevels[CurrentLODIndex] : nullptr;
+	const bool bSimulate = !LOD || LOD->bSimulatePhysics;
+	const bool bCollide = !LOD || LOD->bEnableCollisions;
+	const float RateFactor = LOD ? LOD->SimulationRateFactor : 1.0f;
+
+	if (UsesParticleSolver())
+	{
+		UChainSimulationSubsystem* Subsystem = GetSimulationSubsystem();
+		if (Subsystem && ParticleChainId != INDEX_NONE)
 		{
-			LinkComponents[0]->AttachToComponent(StartAnchor.Component,
-				FAttachmentTransformRules::SnapToTargetIncludingScale,
-				StartAnchor.SocketName);
+			Subsystem->SetChainStepping(ParticleChainId, bSimulate, RateFactor,
+				Profile->GetIterationsForLOD(CurrentLODIndex), Profile->GetSubstepsForLOD(CurrentLODIndex));
+			Subsystem->SetChainCollision(ParticleChainId, MakeWorldCollision(*Profile, CurrentLODIndex));
 		}
+		return;
 	}
 
-	// Anchor last link
-	if (Profile->bSupportsLooseEnd == false && LinkComponents.IsValidIndex(LinkComponents.Num() - 1))
+	// Chaos steps every body at the same rate, only simulation, collision and per-body iterations can be changed.
+	const int32 BodyIterations = Profile->GetRigidBodyIterationsForLOD(CurrentLODIndex);
+	for (UStaticMeshComponent* Link : LinkComponents)
 	{
-		if (!EndAnchor.bUseWorldLocation && EndAnchor.Component)
+		if (!Link) continue;
+
+		// Links attached to an anchor by BindAnchors keep their state, SetSimulatePhysics would detach them
+		const USceneComponent* Parent = Link->GetAttachParent();
+		if (!Parent || Parent == RootComponent)
 		{
-			LinkComponents.Last()->AttachToComponent(EndAnchor.Component,
-				FAttachmentTransformRules::KeepWorldTransform,
-				EndAnchor.SocketName);
+			Link->SetSimulatePhysics(bSimulate);
 		}
-		else if (EndAnchor.bUseWorldLocation)
+		ApplyLinkCollision(Link, bCollide);
+
+		if (BodyIterations > 0)
 		{
-			LinkComponents.Last()->SetWorldLocation(EndAnchor.WorldLocation);
+			if (FBodyInstance* Body = Link->GetBodyInstance())
+			{
+				Body->SetPositionSolverIterationCount(static_cast<uint8>(BodyIterations));
+			}
+		}
+	}
+}
+
+void AChainInstanceActor::GetChainPose(TArray<FVector>& OutPose) const
+{
+	OutPose.Reset();
+
+	if (UsesParticleSolver())
+	{
+		const UChainSimulationSubsystem* Subsystem = GetSimulationSubsystem();
+		if (Subsystem && ParticleChainId != INDEX_NONE)
+		{
+			Subsystem->GetSolver().GetParticlePositions(ParticleChainId, OutPose);
+			return;
+		}
+	}
+
+	for (const UStaticMeshComponent* Link : LinkComponents)
+	{
+		if (Link)
+		{
+			OutPose.Add(Link->GetComponentLocation());
 		}
 	}
 }
@@ -205,6 +1520,7 @@ void AChainInstanceActor::BindAnchors()
 void AChainInstanceActor::SetStartAnchor(const FChainAnchor& NewAnchor)
 {
 	StartAnchor = NewAnchor;
+	WakeUp();
 	if (bAutoRebuild)
 	{
 		RebuildChain();
@@ -214,6 +1530,7 @@ void AChainInstanceActor::SetStartAnchor(const FChainAnchor& NewAnchor)
 void AChainInstanceActor::SetEndAnchor(const FChainAnchor& NewAnchor)
 {
 	EndAnchor = NewAnchor;
+	WakeUp();
 	if (bAutoRebuild)
 	{
 		RebuildChain();
@@ -224,8 +1541,18 @@ void AChainInstanceActor::SetTargetLength(float NewLength)
 {
 	if (!Profile || !Profile->bAllowDynamicLengthChange) return;
 
-	// Placeholder: we will handle dynamic constraint re-param later.
-	UE_LOG(LogTemp, Warning, TEXT("Dynamic length change not implemented yet."));
+	if (!UsesParticleSolver())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Dynamic length change requires the XPBD simulation backend."));
+		return;
+	}
+
+	// UpdateReel moves towards it from the simulation subsystem, one bounded step per frame
+	TargetLength = FMath::Clamp(NewLength, Profile->MinLength, Profile->GetMaxLength());
+	if (TargetLength != CurrentLength)
+	{
+		WakeUp();
+	}
 }
 
 void AChainInstanceActor::BreakLink(int32 LinkIndex)
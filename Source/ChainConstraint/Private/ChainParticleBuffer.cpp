@@ -0,0 +1,64 @@
+#include "ChainParticleBuffer.h"
+
+template <typename FunctionType>
+void FChainParticleBuffer::ForEachArray(FunctionType&& Function)
+{
+	FChainFloatArray* Arrays[] =
+	{
+		&PosX, &PosY, &PosZ,
+		&PrevX, &PrevY, &PrevZ,
+		&VelX, &VelY, &VelZ,
+		&InvMass, &GravityScale, &Damping,
+		&DistanceRest, &DistanceCompliance, &DistanceMask, &DistanceLambda,
+		&BendRest, &BendCompliance, &BendMask, &BendLambda,
+		&TetherRest,
+		&ContactNX, &ContactNY, &ContactNZ, &ContactOffset, &ContactParam, &ContactFriction, &ContactMask
+	};
+
+	for (FChainFloatArray* Array : Arrays)
+	{
+		Function(*Array);
+	}
+	Function(TetherAnchor);
+}
+
+int32 FChainParticleBuffer::AddParticles(int32 Count)
+{
+	check(Count % ChainParticleBlockSize == 0);
+
+	const int32 Begin = Num();
+	ForEachArray([Count](auto& Array)
+	{
+		Array.AddZeroed(Count);
+	});
+
+	return Begin;
+}
+
+void FChainParticleBuffer::ClearRange(int32 Begin, int32 Count)
+{
+	check(Begin >= 0 && Begin + Count <= Num());
+
+	ForEachArray([Begin, Count](auto& Array)
+	{
+		FMemory::Memzero(Array.GetData() + Begin, Count * sizeof(Array[0]));
+	});
+}
+
+void FChainParticleBuffer::Truncate(int32 NewNum)
+{
+	check(NewNum % ChainParticleBlockSize == 0 && NewNum >= 0 && NewNum <= Num());
+
+	ForEachArray([NewNum](auto& Array)
+	{
+		Array.SetNum(NewNum, EAllowShrinking::No);
+	});
+}
+
+void FChainParticleBuffer::Empty()
+{
+	ForEachArray([](auto& Array)
+	{
+		Array.Empty();
+	});
+}
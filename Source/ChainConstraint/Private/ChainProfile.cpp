@@ -1,4 +1,6 @@
 #include "ChainProfile.h"
+#include "ChainXPBDSolver.h"
+#include "PhysicsEngine/PhysicsSettings.h"
 
 UChainProfile::UChainProfile()
 {
@@ -12,6 +14,8 @@ UChainProfile::UChainProfile()
 		DefaultLOD.bSimulatePhysics = true;
 		DefaultLOD.bEnableCollisions = true;
 		DefaultLOD.SimulationRateFactor = 1.0f;
+		DefaultLOD.IterationScale = 1.0f;
+		DefaultLOD.MaxSubsteps = 0;
 
 		LODLevels.Add(DefaultLOD);
 	}
@@ -27,6 +31,15 @@ float UChainProfile::GetBaseLength() const
 	return FMath::Max(1.0f, Visual.DefaultLength);
 }
 
+float UChainProfile::GetMaxLength() const
+{
+	if (!bAllowDynamicLengthChange)
+	{
+		return GetBaseLength();
+	}
+	return FMath::Max(GetBaseLength(), MaxLength);
+}
+
 int32 UChainProfile::GetLODIndexForDistance(float Distance) const
 {
 	const float SafeDistance = FMath::Max(0.0f, Distance);
@@ -44,11 +57,15 @@ int32 UChainProfile::GetLODIndexForDistance(float Distance) const
 }
 
 int32 UChainProfile::GetSegmentCountAtDistance(float Distance) const
+{
+	return GetSegmentCountForLOD(GetLODIndexForDistance(Distance));
+}
+
+int32 UChainProfile::GetSegmentCountForLOD(int32 LODIndex) const
 {
 	const int32 BaseSegments = GetBaseSegmentCount();
-	const int32 LODIndex = GetLODIndexForDistance(Distance);
 
-	if (LODIndex == INDEX_NONE)
+	if (!LODLevels.IsValidIndex(LODIndex))
 	{
 		return BaseSegments;
 	}
@@ -62,3 +79,234 @@ int32 UChainProfile::GetSegmentCountAtDistance(float Distance) const
 	// Ensure at least 2 segments for a valid chain.
 	return FMath::Max(2, LOD.SegmentCountOverride);
 }
+
+int32 UChainProfile::GetIterationsForLOD(int32 LODIndex) const
+{
+	const float Scale = LODLevels.IsValidIndex(LODIndex) ? LODLevels[LODIndex].IterationScale : 1.0f;
+	return FMath::Max(1, FMath::RoundToInt(Simulation.Iterations * Scale));
+}
+
+int32 UChainProfile::GetSubstepsForLOD(int32 LODIndex) const
+{
+	const int32 Substeps = FMath::Max(1, Simulation.Substeps);
+	if (!LODLevels.IsValidIndex(LODIndex) || LODLevels[LODIndex].MaxSubsteps <= 0)
+	{
+		return Substeps;
+	}
+	return FMath::Min(Substeps, LODLevels[LODIndex].MaxSubsteps);
+}
+
+int32 UChainProfile::GetRigidBodyIterationsForLOD(int32 LODIndex) const
+{
+	if (Physics.PositionSolverIterations <= 0)
+	{
+		return 0;
+	}
+
+	const float Scale = LODLevels.IsValidIndex(LODIndex) ? LODLevels[LODIndex].IterationScale : 1.0f;
+	return FMath::Clamp(FMath::RoundToInt(Physics.PositionSolverIterations * Scale), 1, 255);
+}
+
+bool UChainProfile::UsesParticleSolver() const
+{
+	return Simulation.Backend == EChainSimulationBackend::XPBD;
+}
+
+bool UChainProfile::UsesInstancedLinks() const
+{
+	return UsesParticleSolver() && Visual.RenderMode == EChainRenderMode::Instanced && Visual.LinkMesh != nullptr;
+}
+
+bool UChainProfile::UsesTubeMesh() const
+{
+	return UsesParticleSolver() && Visual.RenderMode == EChainRenderMode::Tube;
+}
+
+const FChainCompiledTemplate& UChainProfile::GetCompiledTemplate() const
+{
+	if (CompiledTemplate.IsValid())
+	{
+		return *CompiledTemplate;
+	}
+
+	static uint32 NextTemplateSerial = 0;
+	TSharedRef<FChainCompiledTemplate> Template = MakeShared<FChainCompiledTemplate>();
+	Template->Serial = ++NextTemplateSerial;
+
+	// Rigid body links
+	FBodyInstance& Body = Template->SimulatedLinkBody;
+	Body.SetInstanceSimulatePhysics(true);
+	Body.SetMassOverride(Physics.LinkMass, true);
+	Body.LinearDamping = Physics.LinearDamping;
+	Body.AngularDamping = Physics.AngularDamping;
+	if (Physics.CollisionProfileName != NAME_None)
+	{
+		Body.SetCollisionProfileName(Physics.CollisionProfileName);
+	}
+	else
+	{
+		Body.SetObjectType(Physics.CollisionChannel);
+		Body.SetResponseToAllChannels(ECR_Block);
+	}
+	Body.SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics, false);
+	Body.SetInstanceNotifyRBCollision(Physics.bNotifyRigidBodyCollision);
+
+	// Collision toggled on live links by the LOD levels, read back so a collision profile is resolved once
+	Template->LinkCollision.CollisionEnabled = Body.GetCollisionEnabled(false);
+	Template->LinkCollision.ObjectType = Body.GetObjectType();
+	Template->LinkCollision.Responses = Body.GetResponseToChannels();
+	Template->IgnoredLinkCollision.CollisionEnabled = ECollisionEnabled::PhysicsOnly;
+	Template->IgnoredLinkCollision.ObjectType = Body.GetObjectType();
+	Template->IgnoredLinkCollision.Responses.SetAllChannels(ECR_Ignore);
+
+	// Particle chain links only carry the mesh
+	Template->RenderLinkBody.SetInstanceSimulatePhysics(false);
+	Template->RenderLinkBody.SetCollisionEnabled(ECollisionEnabled::NoCollision, false);
+
+	// Joints
+	FConstraintProfileProperties& Joint = Template->ConstraintProfile;
+	Joint.ConeLimit.Swing1Motion = Constraint.bEnableSwing ? ACM_Limited : ACM_Free;
+	Joint.ConeLimit.Swing2Motion = Joint.ConeLimit.Swing1Motion;
+	Joint.ConeLimit.Swing1LimitDegrees = Constraint.MaxSwingAngle;
+	Joint.ConeLimit.Swing2LimitDegrees = Constraint.MaxSwingAngle;
+	Joint.TwistLimit.TwistMotion = Constraint.bEnableTwist ? ACM_Limited : ACM_Free;
+	Joint.TwistLimit.TwistLimitDegrees = Constraint.MaxTwistAngle;
+
+	const ELinearConstraintMotion LinearMotion = Constraint.LinearLimit > 0 ? LCM_Limited : LCM_Free;
+	Joint.LinearLimit.XMotion = LinearMotion;
+	Joint.LinearLimit.YMotion = LinearMotion;
+	Joint.LinearLimit.ZMotion = LinearMotion;
+	Joint.LinearLimit.Limit = FMath::Max(0.0f, Constraint.LinearLimit);
+
+	Joint.LinearDrive.SetDriveParams(Constraint.LinearStiffness, 0.f, 0.f);
+	Joint.AngularDrive.SetDriveParams(Constraint.AngularStiffness, 0.f, 0.f);
+
+	Joint.LinearBreakThreshold = Constraint.BreakForce;
+	Joint.AngularBreakThreshold = Constraint.BreakTorque;
+
+	CompiledTemplate = Template;
+	return *Template;
+}
+
+#if WITH_EDITOR
+void UChainProfile::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	InvalidateCompiledTemplate();
+}
+#endif
+
+bool FChainRestPoseTable::Sample(float SpanRatio, float Pitch, int32 NumPoints, TArray<FVector2f>& OutPoints) const
+{
+	if (!IsValid() || NumPoints < 2 || SpanRatio > MaxSpanRatio) return false;
+
+	// Grid coordinates of the requested pose
+	const float SpanCoord = FMath::Clamp(SpanRatio / MaxSpanRatio, 0.0f, 1.0f) * (NumSpanSamples - 1);
+	const float PitchCoord = FMath::Clamp(Pitch / UE_PI + 0.5f, 0.0f, 1.0f) * (NumPitchSamples - 1);
+	const int32 Span0 = FMath::Min(FMath::FloorToInt(SpanCoord), NumSpanSamples - 2);
+	const int32 Pitch0 = FMath::Min(FMath::FloorToInt(PitchCoord), NumPitchSamples - 2);
+	const float SpanAlpha = SpanCoord - Span0;
+	const float PitchAlpha = PitchCoord - Pitch0;
+
+	const FVector2f* Pose00 = &Points[(Pitch0 * NumSpanSamples + Span0) * PointsPerPose];
+	const FVector2f* Pose10 = Pose00 + PointsPerPose;
+	const FVector2f* Pose01 = Pose00 + NumSpanSamples * PointsPerPose;
+	const FVector2f* Pose11 = Pose01 + PointsPerPose;
+
+	OutPoints.SetNumUninitialized(NumPoints);
+	for (int32 Index = 0; Index < NumPoints; ++Index)
+	{
+		// Resample along the chain, then blend the four surrounding poses
+		const float PointCoord = static_cast<float>(Index) / (NumPoints - 1) * (PointsPerPose - 1);
+		const int32 Point0 = FMath::Min(FMath::FloorToInt(PointCoord), PointsPerPose - 2);
+		const float PointAlpha = PointCoord - Point0;
+
+		auto Resample = [Point0, PointAlpha](const FVector2f* Pose)
+		{
+			return FMath::Lerp(Pose[Point0], Pose[Point0 + 1], PointAlpha);
+		};
+		OutPoints[Index] = FMath::Lerp(
+			FMath::Lerp(Resample(Pose00), Resample(Pose10), SpanAlpha),
+			FMath::Lerp(Resample(Pose01), Resample(Pose11), SpanAlpha),
+			PitchAlpha);
+	}
+	return true;
+}
+
+void UChainProfile::BakeRestPoses()
+{
+	const int32 NumSegments = GetBaseSegmentCount();
+	const float Length = GetBaseLength();
+	const float SegmentLength = Length / NumSegments;
+	const FVector Gravity(0.0, 0.0, UPhysicsSettings::Get()->DefaultGravityZ);
+
+	FChainSolverChainSettings Settings;
+	Settings.ParticleMass = Physics.LinkMass;
+	Settings.DistanceCompliance = Simulation.DistanceCompliance;
+	Settings.bEnableBending = Simulation.bEnableBendConstraints;
+	Settings.BendCompliance = Simulation.BendCompliance;
+	Settings.GravityScale = Simulation.GravityScale;
+	Settings.bEnableTethers = Simulation.bEnableTethers;
+	Settings.TetherStretch = Simulation.TetherStretch;
+
+	// Heavy damping only speeds up settling, the rest pose does not depend on it
+	Settings.Damping = FMath::Max(Physics.LinearDamping, 2.0f);
+
+	constexpr float DeltaTime = 1.0f / 60.0f;
+	constexpr int32 MaxSteps = 1200;
+	const float RestSpeedSq = FMath::Square(FMath::Max(0.1f, Sleep.SleepSpeedThreshold * 0.5f));
+
+	FChainRestPoseTable Table;
+	Table.NumSpanSamples = FMath::Max(2, RestPoseSpanSamples);
+	Table.NumPitchSamples = FMath::Max(2, RestPosePitchSamples);
+	Table.PointsPerPose = FMath::Max(3, RestPosePoints);
+	Table.MaxSpanRatio = 0.98f;
+	Table.Points.Reserve(Table.NumSpanSamples * Table.NumPitchSamples * Table.PointsPerPose);
+
+	TArray<FVector> Positions;
+	for (int32 PitchIndex = 0; PitchIndex < Table.NumPitchSamples; ++PitchIndex)
+	{
+		const float Pitch = (static_cast<float>(PitchIndex) / (Table.NumPitchSamples - 1) - 0.5f) * UE_PI;
+		for (int32 SpanIndex = 0; SpanIndex < Table.NumSpanSamples; ++SpanIndex)
+		{
+			const float Span = static_cast<float>(SpanIndex) / (Table.NumSpanSamples - 1) * Table.MaxSpanRatio * Length;
+			const FVector End(FMath::Cos(Pitch) * Span, 0.0, FMath::Sin(Pitch) * Span);
+
+			// Start from a V of the right length, sagging below the anchors' midpoint
+			const FVector Middle = End * 0.5 - FVector::UpVector * FMath::Sqrt(FMath::Max(0.0f, FMath::Square(Length * 0.5f) - FMath::Square(Span * 0.5f)));
+			Positions.SetNumUninitialized(NumSegments + 1);
+			for (int32 Index = 0; Index <= NumSegments; ++Index)
+			{
+				const float Alpha = static_cast<float>(Index) / NumSegments * 2.0f;
+				Positions[Index] = Alpha <= 1.0f ? FMath::Lerp(FVector::ZeroVector, Middle, Alpha) : FMath::Lerp(Middle, End, Alpha - 1.0f);
+			}
+
+			FChainXPBDSolver Solver;
+			Solver.SetIterations(FMath::Max(Simulation.Iterations, 8));
+			const int32 ChainId = Solver.AddChain(Positions, Settings);
+			Solver.SetSegmentRestLength(ChainId, SegmentLength);
+			Solver.SetParticlePinned(ChainId, 0, true);
+			Solver.SetParticlePinned(ChainId, NumSegments, true);
+
+			for (int32 Step = 0; Step < MaxSteps; ++Step)
+			{
+				Solver.Step(DeltaTime, Gravity);
+				if (Step > 30 && Solver.GetMaxSpeedSquared(ChainId) <= RestSpeedSq) break;
+			}
+			Solver.GetParticlePositions(ChainId, Positions);
+
+			// Store the pose resampled to the table's point count, in units of the chain length
+			for (int32 Point = 0; Point < Table.PointsPerPose; ++Point)
+			{
+				const float Coord = static_cast<float>(Point) / (Table.PointsPerPose - 1) * NumSegments;
+				const int32 Index = FMath::Min(FMath::FloorToInt(Coord), NumSegments - 1);
+				const FVector Position = FMath::Lerp(Positions[Index], Positions[Index + 1], Coord - Index);
+				Table.Points.Emplace(static_cast<float>(Position.X / Length), static_cast<float>(Position.Z / Length));
+			}
+		}
+	}
+
+	RestPoses = MoveTemp(Table);
+	MarkPackageDirty();
+}
@@ -0,0 +1,1284 @@
+#include "ChainSimulationSubsystem.h"
+#include "ChainAsyncSimulation.h"
+#include "ChainInstanceActor.h"
+#include "ChainProfile.h"
+#include "ChainStats.h"
+#include "Async/ParallelFor.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeExit.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+static TAutoConsoleVariable<int32> CVarChainIslandParticleBudget(
+	TEXT("Chain.Simulation.IslandParticleBudget"),
+	1024,
+	TEXT("Maximum number of particles grouped into one solver task. Smaller islands spread better across cores."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarChainSolveBudgetMs(
+	TEXT("Chain.Simulation.BudgetMs"),
+	0.0f,
+	TEXT("Game thread solve budget per frame, in milliseconds. Over budget, the farthest chains lose substeps and iterations first, then skip a frame. 0 = unlimited."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<bool> CVarChainAsyncSimulation(
+	TEXT("Chain.Simulation.Async"),
+	false,
+	TEXT("Solve XPBD chains on the async physics thread at the fixed physics tick, with interpolated results. Requires async physics (Tick Physics Async)."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarChainWakeOverlapInterval(
+	TEXT("Chain.Sleep.OverlapCheckInterval"),
+	0.2f,
+	TEXT("Seconds between two overlap checks waking sleeping chains up."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarChainBuildBudgetMs(
+	TEXT("Chain.Build.BudgetMs"),
+	2.0f,
+	TEXT("Game thread time per frame spent on time-sliced chain builds (bAsyncBuild), in milliseconds. At least one component is built every frame."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarChainLODUpdateInterval(
+	TEXT("Chain.LOD.UpdateInterval"),
+	0.25f,
+	TEXT("Seconds between two evaluations of chain LOD levels. 0 = every frame."),
+	ECVF_Default);
+
+void UChainSimulationSubsystem::Deinitialize()
+{
+	Solver.SetCommandRecording(nullptr);
+	AsyncSimulation.Reset();
+
+	Chains.Empty();
+	AnchorTracker.Reset();
+	Restraints = FChainRestraintFragments();
+	RestraintProfiles.Empty();
+	Islands.Empty();
+	ChainActors.Empty();
+	LinkInstances.Empty();
+	InstanceHost = nullptr;
+	Solver.Reset();
+
+	Super::Deinitialize();
+}
+
+TStatId UChainSimulationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UChainSimulationSubsystem, STATGROUP_Tickables);
+}
+
+int32 UChainSimulationSubsystem::RegisterChain(AChainInstanceActor* Chain, TConstArrayView<FVector> Positions, const FChainSolverChainSettings& Settings, int32 Iterations, int32 Substeps, float MaxDeltaTime, float FixedTimeStep)
+{
+	if (!Chain) return INDEX_NONE;
+
+	const int32 ChainId = AddSolverChain(Positions, Settings, Iterations, Substeps, MaxDeltaTime, FixedTimeStep);
+	if (ChainId != INDEX_NONE)
+	{
+		Chains[ChainId].Actor = Chain;
+	}
+	return ChainId;
+}
+
+int32 UChainSimulationSubsystem::AddSolverChain(TConstArrayView<FVector> Positions, const FChainSolverChainSettings& Settings, int32 Iterations, int32 Substeps, float MaxDeltaTime, float FixedTimeStep)
+{
+	const int32 ChainId = Solver.AddChain(Positions, Settings);
+	if (ChainId == INDEX_NONE) return INDEX_NONE;
+
+	FRegisteredChain& Entry = Chains.Add(ChainId);
+	Entry.Iterations = FMath::Max(1, Iterations);
+	Entry.Substeps = FMath::Max(1, Substeps);
+	Entry.MaxDeltaTime = MaxDeltaTime;
+	Entry.FixedTimeStep = FMath::Max(0.0f, FixedTimeStep);
+	bLinkInstancesDirty = true;
+
+	return ChainId;
+}
+
+void UChainSimulationSubsystem::UnregisterChain(int32 ChainId)
+{
+	if (Chains.Remove(ChainId) > 0)
+	{
+		Solver.RemoveChain(ChainId);
+		bLinkInstancesDirty = true;
+	}
+}
+
+void UChainSimulationSubsystem::SetChainStepping(int32 ChainId, bool bSimulate, float RateFactor, int32 Iterations, int32 Substeps)
+{
+	if (FRegisteredChain* Entry = Chains.Find(ChainId))
+	{
+		Entry->bSimulate = bSimulate;
+		Entry->RateFactor = FMath::Clamp(RateFactor, 0.01f, 1.0f);
+		Entry->Iterations = FMath::Max(1, Iterations);
+		Entry->Substeps = FMath::Max(1, Substeps);
+	}
+}
+
+void UChainSimulationSubsystem::SetChainCollision(int32 ChainId, const FChainWorldCollision& Collision)
+{
+	FRegisteredChain* Entry = Chains.Find(ChainId);
+	if (!Entry) return;
+
+	Entry->Collision = Collision;
+	Entry->Collision.Radius = FMath::Max(0.1f, Collision.Radius);
+
+	if (!Collision.bEnabled)
+	{
+		Entry->ContactSegments.Reset();
+		Solver.SetSegmentContacts(ChainId, TConstArrayView<FChainSegmentContact>(), 0.0f);
+	}
+}
+
+UChainSimulationSubsystem::FChainRestraintAnchor::FChainRestraintAnchor(const FChainAnchor& Anchor)
+	: Component(Anchor.Component)
+	, SocketName(Anchor.SocketName)
+	, WorldLocation(Anchor.WorldLocation)
+	, bUseWorldLocation(Anchor.bUseWorldLocation)
+{
+}
+
+FVector UChainSimulationSubsystem::FChainRestraintAnchor::Resolve(FChainAnchorTracker& Tracker, FVector* OutVelocity) const
+{
+	USceneComponent* SceneComponent = bUseWorldLocation ? nullptr : Component.Get();
+	if (!SceneComponent)
+	{
+		if (OutVelocity)
+		{
+			*OutVelocity = FVector::ZeroVector;
+		}
+		return WorldLocation;
+	}
+	return Tracker.Resolve(SceneComponent, SocketName, OutVelocity);
+}
+
+FChainAnchor UChainSimulationSubsystem::FChainRestraintAnchor::ToChainAnchor() const
+{
+	FChainAnchor Anchor;
+	Anchor.Component = Component.Get();
+	Anchor.SocketName = SocketName;
+	Anchor.WorldLocation = WorldLocation;
+	Anchor.bUseWorldLocation = bUseWorldLocation;
+	return Anchor;
+}
+
+FChainRestraintHandle UChainSimulationSubsystem::AddRestraint(UChainProfile* Profile, const FChainAnchor& StartAnchor, const FChainAnchor& EndAnchor)
+{
+	if (!Profile || !Profile->UsesInstancedLinks()) return FChainRestraintHandle();
+
+	const FChainRestraintAnchor Start(StartAnchor);
+	const FChainRestraintAnchor End = Profile->bSupportsLooseEnd ? FChainRestraintAnchor() : FChainRestraintAnchor(EndAnchor);
+	if (!Start.IsBound() && !End.IsBound()) return FChainRestraintHandle();
+
+	// Straight from the start anchor towards the end anchor, or hanging down from the only bound one
+	const int32 NumSegments = Profile->GetSegmentCountForLOD(INDEX_NONE);
+	const float SegmentLength = Profile->GetBaseLength() / NumSegments;
+	TArray<FVector> Positions;
+	Positions.SetNumUninitialized(NumSegments + 1);
+	if (Start.IsBound())
+	{
+		const FVector Origin = Start.Resolve(AnchorTracker);
+		const FVector Direction = End.IsBound() ? (End.Resolve(AnchorTracker) - Origin).GetSafeNormal(UE_SMALL_NUMBER, -FVector::UpVector) : -FVector::UpVector;
+		for (int32 i = 0; i <= NumSegments; ++i)
+		{
+			Positions[i] = Origin + Direction * (SegmentLength * i);
+		}
+	}
+	else
+	{
+		const FVector Origin = End.Resolve(AnchorTracker);
+		for (int32 i = 0; i <= NumSegments; ++i)
+		{
+			Positions[i] = Origin - FVector::UpVector * (SegmentLength * (NumSegments - i));
+		}
+	}
+
+	const FChainSimulationSettings& Sim = Profile->Simulation;
+	const int32 ChainId = AddSolverChain(Positions, AChainInstanceActor::MakeSolverChainSettings(*Profile),
+		Profile->GetIterationsForLOD(INDEX_NONE), Profile->GetSubstepsForLOD(INDEX_NONE), Sim.MaxDeltaTime, Sim.FixedTimeStep);
+	if (ChainId == INDEX_NONE) return FChainRestraintHandle();
+
+	Chains[ChainId].bRestraint = true;
+	Solver.SetSegmentRestLength(ChainId, SegmentLength);
+	Solver.SetParticlePinned(ChainId, 0, Start.IsBound());
+	Solver.SetParticlePinned(ChainId, NumSegments, End.IsBound());
+
+	// Hit events need an actor to be broadcast from
+	FChainWorldCollision Collision = AChainInstanceActor::MakeWorldCollision(*Profile, INDEX_NONE);
+	Collision.bNotifyHits = false;
+	SetChainCollision(ChainId, Collision);
+
+	int32 Slot = INDEX_NONE;
+	if (Restraints.FreeSlots.Num() > 0)
+	{
+		Slot = Restraints.FreeSlots.Pop(EAllowShrinking::No);
+	}
+	else
+	{
+		Slot = Restraints.SlotEntities.Add(INDEX_NONE);
+		Restraints.SlotSerials.Add(1);
+	}
+
+	const int32 Entity = Restraints.ChainIds.Add(ChainId);
+	Restraints.ProfileIndices.Add(RestraintProfiles.AddUnique(Profile));
+	Restraints.StartAnchors.Add(Start);
+	Restraints.EndAnchors.Add(End);
+	Restraints.LinkBegins.Add(Restraints.LinkTransforms.Num());
+	Restraints.Slots.Add(Slot);
+	Restraints.LinkTransforms.AddDefaulted(NumSegments);
+	Restraints.SlotEntities[Slot] = Entity;
+	WriteRestraintLinks(Entity);
+
+	FChainRestraintHandle Handle;
+	Handle.Slot = Slot;
+	Handle.Serial = Restraints.SlotSerials[Slot];
+	return Handle;
+}
+
+void UChainSimulationSubsystem::RemoveRestraint(FChainRestraintHandle Handle)
+{
+	const int32 Entity = FindRestraint(Handle);
+	if (Entity != INDEX_NONE)
+	{
+		RemoveRestraintAt(Entity);
+	}
+}
+
+void UChainSimulationSubsystem::SetRestraintAnchors(FChainRestraintHandle Handle, const FChainAnchor& StartAnchor, const FChainAnchor& EndAnchor)
+{
+	const int32 Entity = FindRestraint(Handle);
+	if (Entity == INDEX_NONE) return;
+
+	const UChainProfile* Profile = RestraintProfiles[Restraints.ProfileIndices[Entity]];
+	Restraints.StartAnchors[Entity] = FChainRestraintAnchor(StartAnchor);
+	Restraints.EndAnchors[Entity] = Profile->bSupportsLooseEnd ? FChainRestraintAnchor() : FChainRestraintAnchor(EndAnchor);
+
+	const int32 ChainId = Restraints.ChainIds[Entity];
+	Solver.SetParticlePinned(ChainId, 0, Restraints.StartAnchors[Entity].IsBound());
+	Solver.SetParticlePinned(ChainId, Solver.GetNumParticles(ChainId) - 1, Restraints.EndAnchors[Entity].IsBound());
+}
+
+AChainInstanceActor* UChainSimulationSubsystem::PromoteRestraint(FChainRestraintHandle Handle)
+{
+	const int32 Entity = FindRestraint(Handle);
+	if (Entity == INDEX_NONE) return nullptr;
+
+	TArray<FVector3f> Positions;
+	TArray<FVector3f> Velocities;
+	Solver.GetParticleState(Restraints.ChainIds[Entity], Positions, Velocities);
+	const TArray<FTransform> LinkTransforms(Restraints.LinkTransforms.GetData() + Restraints.LinkBegins[Entity], Restraints.GetNumLinks(Entity));
+
+	const FTransform SpawnTransform(FVector(Positions[0]));
+	AChainInstanceActor* Chain = GetWorld()->SpawnActorDeferred<AChainInstanceActor>(AChainInstanceActor::StaticClass(), SpawnTransform,
+		nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+	if (!Chain) return nullptr;
+
+	Chain->Profile = RestraintProfiles[Restraints.ProfileIndices[Entity]];
+	Chain->StartAnchor = Restraints.StartAnchors[Entity].ToChainAnchor();
+	Chain->EndAnchor = Restraints.EndAnchors[Entity].ToChainAnchor();
+	RemoveRestraintAt(Entity);
+	Chain->FinishSpawning(SpawnTransform);
+
+	// Both use the profile's base segment count, so the chain continues from the restraint's pose
+	if (Chain->ParticleChainId != INDEX_NONE && Solver.GetNumParticles(Chain->ParticleChainId) == Positions.Num())
+	{
+		// Links keep turning from the restraint's orientations rather than the fresh build's
+		Solver.SetParticleState(Chain->ParticleChainId, Positions, Velocities);
+		Chain->LinkTransforms = LinkTransforms;
+		Chain->WakeUp();
+		Chain->ApplyParticlesToLinks();
+	}
+	return Chain;
+}
+
+int32 UChainSimulationSubsystem::FindRestraint(FChainRestraintHandle Handle) const
+{
+	if (!Restraints.SlotEntities.IsValidIndex(Handle.Slot) || Restraints.SlotSerials[Handle.Slot] != Handle.Serial)
+	{
+		return INDEX_NONE;
+	}
+	return Restraints.SlotEntities[Handle.Slot];
+}
+
+void UChainSimulationSubsystem::RemoveRestraintAt(int32 Entity)
+{
+	const int32 ChainId = Restraints.ChainIds[Entity];
+	if (Chains.Remove(ChainId) > 0)
+	{
+		Solver.RemoveChain(ChainId);
+	}
+
+	// Later entities move down by one, their links by the removed link count
+	const int32 NumLinks = Restraints.GetNumLinks(Entity);
+	Restraints.LinkTransforms.RemoveAt(Restraints.LinkBegins[Entity], NumLinks, EAllowShrinking::No);
+	for (int32 Other = Entity + 1; Other < Restraints.ChainIds.Num(); ++Other)
+	{
+		Restraints.LinkBegins[Other] -= NumLinks;
+		--Restraints.SlotEntities[Restraints.Slots[Other]];
+	}
+
+	const int32 Slot = Restraints.Slots[Entity];
+	Restraints.SlotEntities[Slot] = INDEX_NONE;
+	++Restraints.SlotSerials[Slot];
+	Restraints.FreeSlots.Add(Slot);
+
+	Restraints.ChainIds.RemoveAt(Entity, EAllowShrinking::No);
+	Restraints.ProfileIndices.RemoveAt(Entity, EAllowShrinking::No);
+	Restraints.StartAnchors.RemoveAt(Entity, EAllowShrinking::No);
+	Restraints.EndAnchors.RemoveAt(Entity, EAllowShrinking::No);
+	Restraints.LinkBegins.RemoveAt(Entity, EAllowShrinking::No);
+	Restraints.Slots.RemoveAt(Entity, EAllowShrinking::No);
+	bLinkInstancesDirty = true;
+}
+
+void UChainSimulationSubsystem::PushRestraintAnchors()
+{
+	for (int32 Entity = 0; Entity < Restraints.ChainIds.Num(); ++Entity)
+	{
+		const int32 ChainId = Restraints.ChainIds[Entity];
+		FChainRestraintAnchor& Start = Restraints.StartAnchors[Entity];
+		FChainRestraintAnchor& End = Restraints.EndAnchors[Entity];
+
+		// An end whose component was destroyed is let go rather than pulled to its fallback location
+		if (Start.IsStale())
+		{
+			Start = FChainRestraintAnchor();
+			Solver.SetParticlePinned(ChainId, 0, false);
+		}
+		if (End.IsStale())
+		{
+			End = FChainRestraintAnchor();
+			Solver.SetParticlePinned(ChainId, Solver.GetNumParticles(ChainId) - 1, false);
+		}
+
+		if (!Chains[ChainId].bSteppedThisFrame) continue;
+
+		FVector Velocity;
+		if (Start.IsBound())
+		{
+			const FVector Location = Start.Resolve(AnchorTracker, &Velocity);
+			SetAnchorTarget(ChainId, 0, Location, Velocity);
+		}
+		if (End.IsBound())
+		{
+			const FVector Location = End.Resolve(AnchorTracker, &Velocity);
+			SetAnchorTarget(ChainId, Solver.GetNumParticles(ChainId) - 1, Location, Velocity);
+		}
+	}
+}
+
+void UChainSimulationSubsystem::UpdateRestraintLinks()
+{
+	for (int32 Entity = 0; Entity < Restraints.ChainIds.Num(); ++Entity)
+	{
+		if (Chains[Restraints.ChainIds[Entity]].bSteppedThisFrame)
+		{
+			WriteRestraintLinks(Entity);
+		}
+	}
+}
+
+void UChainSimulationSubsystem::WriteRestraintLinks(int32 Entity)
+{
+	// Same writer as chain actors, so a promoted restraint does not pop
+	AChainInstanceActor::WriteLinkTransforms(Solver, Restraints.ChainIds[Entity],
+		RestraintProfiles[Restraints.ProfileIndices[Entity]]->Visual.LinkRelativeTransform,
+		TArrayView<FTransform>(Restraints.LinkTransforms.GetData() + Restraints.LinkBegins[Entity], Restraints.GetNumLinks(Entity)));
+}
+
+void UChainSimulationSubsystem::SetAnchorTarget(int32 ChainId, int32 Particle, const FVector& Location, const FVector& Velocity)
+{
+	const FRegisteredChain* Entry = Chains.Find(ChainId);
+	if (Entry && Entry->StepTime > 0.0f)
+	{
+		Solver.SetKinematicTarget(ChainId, Particle, Location - Velocity * Entry->StepTime, Velocity);
+	}
+	else
+	{
+		// The physics thread steps at its own tick, the particle waits there
+		Solver.SetKinematicTarget(ChainId, Particle, Location);
+	}
+}
+
+void UChainSimulationSubsystem::RegisterChainActor(AChainInstanceActor* Chain)
+{
+	if (Chain)
+	{
+		ChainActors.AddUnique(Chain);
+	}
+}
+
+void UChainSimulationSubsystem::UnregisterChainActor(AChainInstanceActor* Chain)
+{
+	ChainActors.RemoveSingleSwap(Chain);
+	PendingBuilds.Remove(Chain);
+}
+
+void UChainSimulationSubsystem::QueueChainBuild(AChainInstanceActor* Chain)
+{
+	if (Chain)
+	{
+		PendingBuilds.AddUnique(Chain);
+	}
+}
+
+void UChainSimulationSubsystem::UpdatePendingBuilds()
+{
+	if (PendingBuilds.Num() == 0) return;
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(UChainSimulationSubsystem::UpdatePendingBuilds);
+
+	const double Deadline = FPlatformTime::Seconds() + CVarChainBuildBudgetMs.GetValueOnGameThread() * 0.001;
+
+	// Oldest first, so the first spawned chains are ready first
+	TArray<TWeakObjectPtr<AChainInstanceActor>, TInlineAllocator<8>> Finished;
+	int32 NumDone = 0;
+	while (NumDone < PendingBuilds.Num())
+	{
+		// An unfinished chain resumes next frame, where it stopped
+		AChainInstanceActor* Chain = PendingBuilds[NumDone].Get();
+		if (Chain && Chain->IsBuildPending())
+		{
+			if (!Chain->ContinueBuild(Deadline)) break;
+			Finished.Add(Chain);
+		}
+
+		++NumDone;
+		if (FPlatformTime::Seconds() >= Deadline) break;
+	}
+	PendingBuilds.RemoveAt(0, NumDone, EAllowShrinking::No);
+
+	// Ready events go after the queue is updated, listeners may rebuild or destroy chains
+	for (const TWeakObjectPtr<AChainInstanceActor>& WeakChain : Finished)
+	{
+		AChainInstanceActor* Chain = WeakChain.Get();
+		if (Chain && !Chain->IsBuildPending())
+		{
+			Chain->OnChainReady.Broadcast(Chain);
+		}
+	}
+}
+
+void UChainSimulationSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const double TickStartTime = FPlatformTime::Seconds();
+	ON_SCOPE_EXIT
+	{
+		LastTickTime = FPlatformTime::Seconds() - TickStartTime;
+	};
+
+	AnchorTracker.BeginFrame(DeltaTime);
+	UpdateAsyncSimulation();
+	UpdatePendingBuilds();
+	UpdateLODs(DeltaTime);
+
+	TimeSinceWakeOverlapCheck += DeltaTime;
+	const bool bCheckOverlaps = TimeSinceWakeOverlapCheck >= CVarChainWakeOverlapInterval.GetValueOnGameThread();
+	if (bCheckOverlaps)
+	{
+		TimeSinceWakeOverlapCheck = 0.0f;
+	}
+
+	// Server key link capture, client key link blending, then sleep and wake checks
+	int32 NumActiveChains = 0;
+	int32 NumActiveLinks = 0;
+	int32 NumSleepingChains = 0;
+	for (const TWeakObjectPtr<AChainInstanceActor>& WeakChain : ChainActors)
+	{
+		if (AChainInstanceActor* Chain = WeakChain.Get())
+		{
+			Chain->UpdateReplication(DeltaTime);
+			Chain->UpdateSleep(DeltaTime, bCheckOverlaps);
+
+			if (Chain->IsSleeping())
+			{
+				++NumSleepingChains;
+			}
+			else if (Chain->HasBuiltChain())
+			{
+				++NumActiveChains;
+				NumActiveLinks += Chain->GetNumLinks();
+			}
+		}
+	}
+	SET_DWORD_STAT(STAT_ChainActiveChains, NumActiveChains);
+	SET_DWORD_STAT(STAT_ChainActiveLinks, NumActiveLinks);
+	SET_DWORD_STAT(STAT_ChainSleepingChains, NumSleepingChains);
+	SET_DWORD_STAT(STAT_ChainTrackedAnchors, AnchorTracker.GetNumTrackedComponents());
+
+	// Drop chains whose actor went away without unregistering
+	for (auto It = Chains.CreateIterator(); It; ++It)
+	{
+		if (!It.Value().bRestraint && !It.Value().Actor.IsValid())
+		{
+			Solver.RemoveChain(It.Key());
+			It.RemoveCurrent();
+			bLinkInstancesDirty = true;
+		}
+	}
+
+	if (Chains.Num() == 0)
+	{
+		if (AsyncSimulation)
+		{
+			AsyncSimulation->FlushCommands();
+		}
+
+		// Clears the instances of the last removed chains
+		UpdateLinkInstances();
+		return;
+	}
+
+	// Length changes only touch the first segment of a chain, never its particle range
+	for (const TPair<int32, FRegisteredChain>& Pair : Chains)
+	{
+		if (!Pair.Value.bRestraint)
+		{
+			Pair.Value.Actor->UpdateReel(DeltaTime);
+		}
+	}
+
+	BuildIslands(DeltaTime);
+
+	// Gather
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ChainGather);
+		for (const TPair<int32, FRegisteredChain>& Pair : Chains)
+		{
+			if (Pair.Value.bSteppedThisFrame && !Pair.Value.bRestraint)
+			{
+				Pair.Value.Actor->PushAnchorTargets();
+			}
+		}
+		PushRestraintAnchors();
+	}
+
+	UpdateWorldContacts(DeltaTime);
+
+	// Solve
+	if (AsyncSimulation)
+	{
+		SolveAsync();
+	}
+	else
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ChainSolve);
+		const double SolveStartTime = FPlatformTime::Seconds();
+
+		const FVector Gravity(0.0f, 0.0f, GetWorld()->GetGravityZ());
+		ParallelFor(Islands.Num(), [this, &Gravity](int32 IslandIndex)
+		{
+			const FChainIsland& Island = Islands[IslandIndex];
+			for (int32 Substep = 0; Substep < Island.NumSubsteps; ++Substep)
+			{
+				if (Island.Group != INDEX_NONE)
+				{
+					const FChainCollisionGroup& Group = CollisionGroups[Island.Group];
+					Solver.StepRanges(Group.Spans, Group.Pairs, Island.SubstepDeltaTime, Gravity, Island.Iterations);
+				}
+				else
+				{
+					Solver.StepRange(Island.Begin, Island.End, Island.SubstepDeltaTime, Gravity, Island.Iterations);
+				}
+			}
+		});
+
+		// Cost model of the budget: milliseconds per particle, iteration and substep, smoothed over frames
+		double SolvedCost = 0.0;
+		for (const FChainIsland& Island : Islands)
+		{
+			const int32 NumParticles = Island.Group != INDEX_NONE ? CollisionGroups[Island.Group].NumParticles : Island.End - Island.Begin;
+			SolvedCost += static_cast<double>(NumParticles) * Island.Iterations * Island.NumSubsteps;
+		}
+		if (SolvedCost > 0.0)
+		{
+			const double MsPerCostUnit = (FPlatformTime::Seconds() - SolveStartTime) * 1000.0 / SolvedCost;
+			SolveMsPerCostUnit = SolveMsPerCostUnit > 0.0 ? FMath::Lerp(SolveMsPerCostUnit, MsPerCostUnit, 0.1) : MsPerCostUnit;
+		}
+	}
+
+	// Write back
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ChainWriteBack);
+		for (const TPair<int32, FRegisteredChain>& Pair : Chains)
+		{
+			if (Pair.Value.bSteppedThisFrame && !Pair.Value.bRestraint)
+			{
+				Pair.Value.Actor->ApplyParticlesToLinks();
+				Pair.Value.Actor->UpdateParticleSleep();
+			}
+		}
+		UpdateRestraintLinks();
+	}
+
+	UpdateLinkInstances();
+
+	// Hit events go last, listeners may change or destroy chains
+	const TArray<FPendingChainHit> Hits = MoveTemp(PendingHits);
+	PendingHits.Reset();
+	for (const FPendingChainHit& Hit : Hits)
+	{
+		if (AChainInstanceActor* Actor = Hit.Actor.Get())
+		{
+			Actor->OnChainHit.Broadcast(Actor, Hit.OtherComponent.Get(), Hit.Location, Hit.Normal, Hit.Segment);
+		}
+	}
+}
+
+void UChainSimulationSubsystem::BuildCollisionGroups()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UChainSimulationSubsystem::BuildCollisionGroups);
+
+	CollisionGroups.Reset();
+	CandidateGroups.Init(INDEX_NONE, StepCandidates.Num());
+	CollisionSegments.Reset();
+	CollisionMiddles.Reset();
+
+	// Every segment of the colliding chains goes into one shared grid
+	const FChainParticleBuffer& Buffer = Solver.GetBuffer();
+	float MaxLength = 0.0f;
+	float MaxRadius = 0.0f;
+	for (int32 CandidateIndex = 0; CandidateIndex < StepCandidates.Num(); ++CandidateIndex)
+	{
+		const FStepCandidate& Candidate = StepCandidates[CandidateIndex];
+		const FChainWorldCollision& Collision = Chains[Candidate.ChainId].Collision;
+		if (Candidate.bDeferred || !Collision.bCollideWithChains) continue;
+
+		const int32 First = Solver.GetFirstParticle(Candidate.ChainId);
+		const int32 NumSegments = Solver.GetNumParticles(Candidate.ChainId) - 1;
+		for (int32 Particle = First; Particle < First + NumSegments; ++Particle)
+		{
+			const FVector3f A = Buffer.GetPosition(Particle);
+			const FVector3f B = Buffer.GetPosition(Particle + 1);
+
+			FChainCollisionSegment& Segment = CollisionSegments.AddDefaulted_GetRef();
+			Segment.Candidate = CandidateIndex;
+			Segment.Particle = Particle;
+			Segment.Radius = Collision.Radius;
+			Segment.Bounds = FBox3f(A.ComponentMin(B), A.ComponentMax(B)).ExpandBy(Collision.Radius);
+			CollisionMiddles.Add((A + B) * 0.5f);
+
+			MaxLength = FMath::Max(MaxLength, Buffer.DistanceRest[Particle]);
+		}
+		MaxRadius = FMath::Max(MaxRadius, Collision.Radius);
+	}
+
+	if (CollisionSegments.Num() == 0) return;
+
+	// Two capsules overlap only if their middles are closer than a segment length plus two radii.
+	// Pairs are kept for the whole frame, a radius of margin catches the segments closing in meanwhile.
+	const float Margin = MaxRadius;
+	CollisionHash.Build(CollisionMiddles, MaxLength + 2.0f * MaxRadius + 2.0f * Margin);
+
+	// Union-find over the candidates joined by at least one pair
+	TArray<int32> Parents;
+	Parents.SetNumUninitialized(StepCandidates.Num());
+	for (int32 Index = 0; Index < Parents.Num(); ++Index)
+	{
+		Parents[Index] = Index;
+	}
+	auto FindRoot = [&Parents](int32 Index)
+	{
+		while (Parents[Index] != Index)
+		{
+			Parents[Index] = Parents[Parents[Index]];
+			Index = Parents[Index];
+		}
+		return Index;
+	};
+
+	TArray<TPair<int32, FChainSegmentPair>> CandidatePairs;
+	TBitArray<> Paired(false, StepCandidates.Num());
+	for (int32 SegmentIndex = 0; SegmentIndex < CollisionSegments.Num(); ++SegmentIndex)
+	{
+		const FChainCollisionSegment& Segment = CollisionSegments[SegmentIndex];
+		const FStepCandidate& Candidate = StepCandidates[Segment.Candidate];
+		const FBox3f Bounds = Segment.Bounds.ExpandBy(Margin);
+
+		CollisionHash.ForEachNeighbour(CollisionMiddles[SegmentIndex], [&](int32 OtherIndex)
+		{
+			const FChainCollisionSegment& Other = CollisionSegments[OtherIndex];
+			if (OtherIndex <= SegmentIndex || Other.Candidate == Segment.Candidate || !Bounds.Intersect(Other.Bounds)) return;
+
+			const FStepCandidate& OtherCandidate = StepCandidates[Other.Candidate];
+			if (Candidate.Iterations != OtherCandidate.Iterations || Candidate.NumSubsteps != OtherCandidate.NumSubsteps || Candidate.SubstepDeltaTime != OtherCandidate.SubstepDeltaTime) return;
+
+			CandidatePairs.Add({ Segment.Candidate, { Segment.Particle, Other.Particle, Segment.Radius + Other.Radius } });
+			Parents[FindRoot(Segment.Candidate)] = FindRoot(Other.Candidate);
+			Paired[Segment.Candidate] = true;
+			Paired[Other.Candidate] = true;
+		});
+	}
+
+	// One group per connected set of chains, chains without pairs keep their own island
+	TMap<int32, int32> RootGroups;
+	for (int32 CandidateIndex = 0; CandidateIndex < StepCandidates.Num(); ++CandidateIndex)
+	{
+		if (!Paired[CandidateIndex]) continue;
+
+		const FStepCandidate& Candidate = StepCandidates[CandidateIndex];
+		const int32 Root = FindRoot(CandidateIndex);
+		int32* GroupIndex = RootGroups.Find(Root);
+		if (!GroupIndex)
+		{
+			GroupIndex = &RootGroups.Add(Root, CollisionGroups.Num());
+			FChainCollisionGroup& NewGroup = CollisionGroups.AddDefaulted_GetRef();
+			NewGroup.Iterations = Candidate.Iterations;
+			NewGroup.NumSubsteps = Candidate.NumSubsteps;
+			NewGroup.SubstepDeltaTime = Candidate.SubstepDeltaTime;
+		}
+
+		FChainCollisionGroup& Group = CollisionGroups[*GroupIndex];
+		FChainParticleSpan& Span = Group.Spans.AddDefaulted_GetRef();
+		Solver.GetChainRange(Candidate.ChainId, Span.Begin, Span.End);
+		Group.NumParticles += Span.End - Span.Begin;
+		CandidateGroups[CandidateIndex] = *GroupIndex;
+	}
+
+	for (FChainCollisionGroup& Group : CollisionGroups)
+	{
+		Group.Spans.Sort([](const FChainParticleSpan& A, const FChainParticleSpan& B)
+		{
+			return A.Begin < B.Begin;
+		});
+	}
+
+	for (const TPair<int32, FChainSegmentPair>& Pair : CandidatePairs)
+	{
+		CollisionGroups[CandidateGroups[Pair.Key]].Pairs.Add(Pair.Value);
+	}
+	INC_DWORD_STAT_BY(STAT_ChainCrossPairs, CandidatePairs.Num());
+}
+
+void UChainSimulationSubsystem::UpdateWorldContacts(float DeltaTime)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UChainSimulationSubsystem::UpdateWorldContacts);
+	SCOPE_CYCLE_COUNTER(STAT_ChainWorldCollision);
+
+	UWorld* World = GetWorld();
+	for (TPair<int32, FRegisteredChain>& Pair : Chains)
+	{
+		FRegisteredChain& Chain = Pair.Value;
+		if (!Chain.bSteppedThisFrame || !Chain.Collision.bEnabled) continue;
+
+		const int32 ChainId = Pair.Key;
+		const FChainWorldCollision& Collision = Chain.Collision;
+		Solver.GetParticlePositions(ChainId, ContactPoints);
+		const int32 NumSegments = ContactPoints.Num() - 1;
+		if (NumSegments < 1) continue;
+
+		// Contacts hold for the whole frame: also catch the geometry the chain can reach before the next query
+		const float Margin = Collision.Radius + FMath::Sqrt(Solver.GetMaxSpeedSquared(ChainId)) * FMath::Min(DeltaTime, Chain.MaxDeltaTime);
+		const FBox Bounds = FBox(ContactPoints).ExpandBy(Collision.Radius + Margin);
+
+		// Broadphase: a single query for the whole chain
+		ContactOverlaps.Reset();
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ChainWorldCollision), false, Chain.Actor.Get());
+		World->OverlapMultiByChannel(ContactOverlaps, Bounds.GetCenter(), FQuat::Identity, Collision.Channel, FCollisionShape::MakeBox(Bounds.GetExtent()), QueryParams);
+
+		SegmentContacts.Reset();
+		TBitArray<> Touching(false, NumSegments);
+
+		for (int32 Segment = 0; Segment < NumSegments && ContactOverlaps.Num() > 0; ++Segment)
+		{
+			const FVector A = ContactPoints[Segment];
+			const FVector B = ContactPoints[Segment + 1];
+			const FVector AB = B - A;
+			const FBox SegmentBounds = FBox(A.ComponentMin(B), A.ComponentMax(B)).ExpandBy(Collision.Radius + Margin);
+			const FCollisionShape SegmentCapsule = FCollisionShape::MakeCapsule(Collision.Radius, static_cast<float>(AB.Size() * 0.5) + Collision.Radius);
+			const FQuat SegmentRotation = AB.IsNearlyZero() ? FQuat::Identity : FRotationMatrix::MakeFromZ(AB).ToQuat();
+
+			// Narrowphase: the deepest body of the segment capsule
+			float BestSeparation = Margin;
+			FChainSegmentContact BestContact;
+			UPrimitiveComponent* BestComponent = nullptr;
+			FVector BestPoint = FVector::ZeroVector;
+
+			for (const FOverlapResult& Overlap : ContactOverlaps)
+			{
+				UPrimitiveComponent* Component = Overlap.GetComponent();
+				if (!Overlap.bBlockingHit || !Component || !Component->Bounds.GetBox().Intersect(SegmentBounds)) continue;
+
+				const FBodyInstance* Body = Component->GetBodyInstance(NAME_None, true, Overlap.ItemIndex);
+				if (!Body) continue;
+
+				// Closest body point to the segment middle, then from the segment point closest to it
+				FVector BodyPoint;
+				FVector BodyNormal;
+				if (!Body->GetClosestPointAndNormal(A + AB * 0.5, BodyPoint, BodyNormal)) continue;
+
+				const float Param = static_cast<float>(FMath::Clamp(FVector::DotProduct(BodyPoint - A, AB) / FMath::Max(AB.SizeSquared(), UE_KINDA_SMALL_NUMBER), 0.0, 1.0));
+				const FVector SegmentPoint = A + AB * Param;
+				if (!Body->GetClosestPointAndNormal(SegmentPoint, BodyPoint, BodyNormal)) continue;
+
+				float Separation = static_cast<float>(FVector::DotProduct(SegmentPoint - BodyPoint, BodyNormal)) - Collision.Radius;
+
+				// A point inside the body is its own closest point, with no depth and no reliable normal:
+				// the segment capsule's minimum translation gives both
+				if (FVector::DistSquared(SegmentPoint, BodyPoint) < UE_KINDA_SMALL_NUMBER)
+				{
+					FMTDResult MTD;
+					if (!Body->OverlapTest(A + AB * 0.5, SegmentRotation, SegmentCapsule, &MTD) || MTD.Direction.IsNearlyZero()) continue;
+
+					BodyNormal = MTD.Direction;
+					Separation = -MTD.Distance;
+					BodyPoint = SegmentPoint + BodyNormal * (MTD.Distance - Collision.Radius);
+				}
+				if (Separation >= BestSeparation) continue;
+
+				BestSeparation = Separation;
+				BestContact.Segment = Segment;
+				BestContact.Param = Param;
+				BestContact.Normal = FVector3f(BodyNormal);
+				BestContact.Offset = static_cast<float>(FVector::DotProduct(BodyPoint, BodyNormal)) + Collision.Radius;
+				BestComponent = Component;
+				BestPoint = BodyPoint;
+			}
+
+			if (!BestComponent) continue;
+
+			SegmentContacts.Add(BestContact);
+
+			if (BestSeparation <= 0.0f)
+			{
+				Touching[Segment] = true;
+
+				const bool bWasTouching = Chain.ContactSegments.IsValidIndex(Segment) && Chain.ContactSegments[Segment];
+				if (Collision.bNotifyHits && !bWasTouching)
+				{
+					PendingHits.Add({ Chain.Actor, BestComponent, BestPoint, FVector(BestContact.Normal), Segment });
+				}
+			}
+		}
+
+		Solver.SetSegmentContacts(ChainId, SegmentContacts, Collision.Friction);
+		Chain.ContactSegments = MoveTemp(Touching);
+		INC_DWORD_STAT_BY(STAT_ChainWorldContacts, SegmentContacts.Num());
+	}
+}
+
+void UChainSimulationSubsystem::UpdateLODs(float DeltaTime)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UChainSimulationSubsystem::UpdateLODs);
+
+	TimeSinceLODUpdate += DeltaTime;
+	if (TimeSinceLODUpdate < CVarChainLODUpdateInterval.GetValueOnGameThread())
+	{
+		return;
+	}
+	TimeSinceLODUpdate = 0.0f;
+
+	TArray<FVector, TInlineAllocator<4>> ViewLocations;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APlayerController* PlayerController = It->Get())
+		{
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+			ViewLocations.Add(ViewLocation);
+		}
+	}
+
+	// Without any view, keep the current levels
+	if (ViewLocations.Num() == 0) return;
+
+	ChainActors.RemoveAllSwap([](const TWeakObjectPtr<AChainInstanceActor>& Chain)
+	{
+		return !Chain.IsValid();
+	});
+
+	for (const TWeakObjectPtr<AChainInstanceActor>& WeakChain : ChainActors)
+	{
+		AChainInstanceActor* Chain = WeakChain.Get();
+		if (!Chain->Profile || !Chain->HasBuiltChain()) continue;
+
+		const FVector ChainLocation = Chain->GetLODReferenceLocation();
+		double ClosestDistanceSq = TNumericLimits<double>::Max();
+		for (const FVector& ViewLocation : ViewLocations)
+		{
+			ClosestDistanceSq = FMath::Min(ClosestDistanceSq, FVector::DistSquared(ViewLocation, ChainLocation));
+		}
+
+		const float ViewDistance = static_cast<float>(FMath::Sqrt(ClosestDistanceSq));
+		if (FRegisteredChain* Entry = Chains.Find(Chain->ParticleChainId))
+		{
+			Entry->ViewDistance = ViewDistance;
+		}
+
+		const int32 LODIndex = Chain->Profile->GetLODIndexForDistance(ViewDistance);
+		if (LODIndex != INDEX_NONE)
+		{
+			Chain->SetLODLevel(LODIndex);
+		}
+	}
+}
+
+void UChainSimulationSubsystem::BuildIslands(float DeltaTime)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UChainSimulationSubsystem::BuildIslands);
+
+	Islands.Reset();
+	StepCandidates.Reset();
+
+	for (TPair<int32, FRegisteredChain>& Pair : Chains)
+	{
+		FRegisteredChain& Chain = Pair.Value;
+		Chain.bSteppedThisFrame = false;
+		Chain.StepTime = 0.0f;
+
+		// Sleeping chains cost nothing until woken up
+		if (!Chain.bSimulate || (!Chain.bRestraint && Chain.Actor->IsSleeping()))
+		{
+			Chain.PendingDeltaTime = 0.0f;
+			continue;
+		}
+
+		FStepCandidate Candidate;
+		Candidate.ChainId = Pair.Key;
+		Candidate.Iterations = Chain.Iterations;
+
+		// The physics thread steps every awake chain at its own fixed tick
+		if (AsyncSimulation)
+		{
+			Candidate.NumSubsteps = Chain.Substeps;
+			StepCandidates.Add(Candidate);
+			continue;
+		}
+
+		// Throttled chains step less often, with the time accumulated since their last step
+		Chain.PendingDeltaTime += DeltaTime;
+		Chain.RateAccumulator += Chain.RateFactor;
+		if (Chain.RateAccumulator < 1.0f)
+		{
+			continue;
+		}
+
+		if (Chain.FixedTimeStep > 0.0f)
+		{
+			// Whole fixed steps only, the remainder waits for the next frame
+			const int32 MaxSteps = FMath::Max(1, FMath::FloorToInt(Chain.MaxDeltaTime / Chain.FixedTimeStep));
+			const int32 NumSteps = FMath::Min(FMath::FloorToInt(Chain.PendingDeltaTime / Chain.FixedTimeStep), MaxSteps);
+			if (NumSteps == 0)
+			{
+				continue;
+			}
+
+			Candidate.NumSubsteps = NumSteps * Chain.Substeps;
+			Candidate.SubstepDeltaTime = Chain.FixedTimeStep / Chain.Substeps;
+			Candidate.ConsumedTime = NumSteps * Chain.FixedTimeStep;
+		}
+		else
+		{
+			Candidate.NumSubsteps = Chain.Substeps;
+			Candidate.SubstepDeltaTime = FMath::Min(Chain.PendingDeltaTime, Chain.MaxDeltaTime) / Chain.Substeps;
+			Candidate.ConsumedTime = Chain.PendingDeltaTime;
+		}
+
+		int32 Begin = 0;
+		int32 End = 0;
+		Solver.GetChainRange(Pair.Key, Begin, End);
+		Candidate.Cost = static_cast<double>(End - Begin) * Candidate.Iterations * Candidate.NumSubsteps;
+		Candidate.ViewDistance = Chain.ViewDistance;
+		StepCandidates.Add(Candidate);
+	}
+
+	if (!AsyncSimulation)
+	{
+		ApplySolveBudget();
+	}
+
+	BuildCollisionGroups();
+
+	for (int32 CandidateIndex = 0; CandidateIndex < StepCandidates.Num(); ++CandidateIndex)
+	{
+		const FStepCandidate& Candidate = StepCandidates[CandidateIndex];
+		FRegisteredChain& Chain = Chains[Candidate.ChainId];
+		if (Candidate.bDeferred)
+		{
+			Chain.bDeferredLastFrame = true;
+			continue;
+		}
+
+		// Grouped chains are stepped by their group's island
+		if (CandidateGroups[CandidateIndex] == INDEX_NONE)
+		{
+			FChainIsland& Island = Islands.AddDefaulted_GetRef();
+			Solver.GetChainRange(Candidate.ChainId, Island.Begin, Island.End);
+			Island.Iterations = Candidate.Iterations;
+			Island.NumSubsteps = Candidate.NumSubsteps;
+			Island.SubstepDeltaTime = Candidate.SubstepDeltaTime;
+		}
+
+		if (!AsyncSimulation)
+		{
+			Chain.RateAccumulator = FMath::Min(Chain.RateAccumulator - 1.0f, 1.0f);
+			Chain.PendingDeltaTime = Chain.FixedTimeStep > 0.0f ? FMath::Min(Chain.PendingDeltaTime - Candidate.ConsumedTime, Chain.FixedTimeStep) : 0.0f;
+		}
+		Chain.bSteppedThisFrame = true;
+		Chain.bDeferredLastFrame = false;
+		Chain.StepTime = Candidate.SubstepDeltaTime * Candidate.NumSubsteps;
+	}
+
+	for (int32 GroupIndex = 0; GroupIndex < CollisionGroups.Num(); ++GroupIndex)
+	{
+		const FChainCollisionGroup& Group = CollisionGroups[GroupIndex];
+		FChainIsland& Island = Islands.AddDefaulted_GetRef();
+		Island.Begin = Group.Spans[0].Begin;
+		Island.End = Group.Spans.Last().End;
+		Island.Iterations = Group.Iterations;
+		Island.NumSubsteps = Group.NumSubsteps;
+		Island.SubstepDeltaTime = Group.SubstepDeltaTime;
+		Island.Group = GroupIndex;
+	}
+
+	Islands.Sort([](const FChainIsland& A, const FChainIsland& B)
+	{
+		return A.Begin < B.Begin;
+	});
+
+	// Merge neighbouring chains with identical step parameters, up to the particle budget
+	const int32 ParticleBudget = FMath::Max(ChainParticleBlockSize, CVarChainIslandParticleBudget.GetValueOnGameThread());
+
+	int32 NumMerged = 0;
+	for (int32 Index = 0; Index < Islands.Num(); ++Index)
+	{
+		const FChainIsland& Candidate = Islands[Index];
+
+		if (NumMerged > 0)
+		{
+			FChainIsland& Last = Islands[NumMerged - 1];
+			const bool bContiguous = Last.End == Candidate.Begin;
+			const bool bSameParams = Last.Iterations == Candidate.Iterations && Last.NumSubsteps == Candidate.NumSubsteps && Last.SubstepDeltaTime == Candidate.SubstepDeltaTime;
+			const bool bUngrouped = Last.Group == INDEX_NONE && Candidate.Group == INDEX_NONE;
+			if (bContiguous && bSameParams && bUngrouped && Candidate.End - Last.Begin <= ParticleBudget)
+			{
+				Last.End = Candidate.End;
+				continue;
+			}
+		}
+
+		Islands[NumMerged++] = Candidate;
+	}
+
+	Islands.SetNum(NumMerged);
+}
+
+void UChainSimulationSubsystem::ApplySolveBudget()
+{
+	const float BudgetMs = CVarChainSolveBudgetMs.GetValueOnGameThread();
+	if (BudgetMs <= 0.0f || SolveMsPerCostUnit <= 0.0) return;
+
+	double PredictedMs = 0.0;
+	for (const FStepCandidate& Candidate : StepCandidates)
+	{
+		PredictedMs += Candidate.Cost * SolveMsPerCostUnit;
+	}
+	if (PredictedMs <= BudgetMs) return;
+
+	// Far chains give up quality first
+	StepCandidates.Sort([](const FStepCandidate& A, const FStepCandidate& B)
+	{
+		return A.ViewDistance > B.ViewDistance;
+	});
+
+	int32 NumDegraded = 0;
+
+	// First pass: one substep per step and half the iterations
+	for (FStepCandidate& Candidate : StepCandidates)
+	{
+		if (PredictedMs <= BudgetMs) break;
+
+		const FRegisteredChain& Chain = Chains[Candidate.ChainId];
+		const int32 NumSteps = FMath::Max(1, Candidate.NumSubsteps / FMath::Max(1, Chain.Substeps));
+		const int32 NewIterations = FMath::Max(1, Candidate.Iterations / 2);
+		if (NumSteps == Candidate.NumSubsteps && NewIterations == Candidate.Iterations) continue;
+
+		const double NewCost = Candidate.Cost / (static_cast<double>(Candidate.Iterations) * Candidate.NumSubsteps) * NewIterations * NumSteps;
+		PredictedMs -= (Candidate.Cost - NewCost) * SolveMsPerCostUnit;
+
+		Candidate.SubstepDeltaTime *= static_cast<float>(Candidate.NumSubsteps) / NumSteps;
+		Candidate.NumSubsteps = NumSteps;
+		Candidate.Iterations = NewIterations;
+		Candidate.Cost = NewCost;
+		++NumDegraded;
+	}
+
+	// Second pass: skip the step, the time is kept for the next frame. A chain is never skipped twice in a row.
+	for (FStepCandidate& Candidate : StepCandidates)
+	{
+		if (PredictedMs <= BudgetMs) break;
+		if (Chains[Candidate.ChainId].bDeferredLastFrame) continue;
+
+		PredictedMs -= Candidate.Cost * SolveMsPerCostUnit;
+		Candidate.bDeferred = true;
+		++NumDegraded;
+	}
+
+	SET_DWORD_STAT(STAT_ChainBudgetDegraded, NumDegraded);
+}
+
+void UChainSimulationSubsystem::UpdateAsyncSimulation()
+{
+	FPhysScene* PhysicsScene = GetWorld()->GetPhysicsScene();
+	Chaos::FPhysicsSolver* PhysicsSolver = PhysicsScene ? PhysicsScene->GetSolver() : nullptr;
+
+	// Without async physics the callback would run inline on the game thread
+	const bool bWantsAsync = CVarChainAsyncSimulation.GetValueOnGameThread() && PhysicsSolver && PhysicsSolver->IsUsingAsyncResults();
+	if (bWantsAsync == AsyncSimulation.IsValid()) return;
+
+	if (bWantsAsync)
+	{
+		AsyncSimulation = MakeShared<FChainAsyncSimulation>(*PhysicsSolver, Solver);
+		Solver.SetCommandRecording(&AsyncSimulation->GetCommandQueue());
+	}
+	else
+	{
+		// The game thread solver holds the last pulled poses and carries on from there
+		Solver.SetCommandRecording(nullptr);
+		AsyncSimulation.Reset();
+	}
+}
+
+void UChainSimulationSubsystem::SolveAsync()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ChainSolve);
+
+	TArray<FChainAsyncIsland> AsyncIslands;
+	AsyncIslands.Reserve(Islands.Num());
+	for (const FChainIsland& Island : Islands)
+	{
+		FChainAsyncIsland& AsyncIsland = AsyncIslands.AddDefaulted_GetRef();
+		AsyncIsland.Begin = Island.Begin;
+		AsyncIsland.End = Island.End;
+		AsyncIsland.Iterations = Island.Iterations;
+		AsyncIsland.NumSubsteps = Island.NumSubsteps;
+		if (Island.Group != INDEX_NONE)
+		{
+			AsyncIsland.Spans = CollisionGroups[Island.Group].Spans;
+			AsyncIsland.Pairs = CollisionGroups[Island.Group].Pairs;
+		}
+	}
+
+	TArray<int32> SteppedChainIds;
+	for (const TPair<int32, FRegisteredChain>& Pair : Chains)
+	{
+		if (Pair.Value.bSteppedThisFrame)
+		{
+			SteppedChainIds.Add(Pair.Key);
+		}
+	}
+
+	AsyncSimulation->PushInput(FVector(0.0f, 0.0f, GetWorld()->GetGravityZ()), AsyncIslands, SteppedChainIds);
+	AsyncSimulation->PullResults(Solver);
+}
+
+void UChainSimulationSubsystem::UpdateLinkInstances()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ChainInstanceUpload);
+
+	// Only batches with a chain that moved are uploaded, all of them when the set of chains changed
+	for (TPair<TObjectPtr<UStaticMesh>, FChainLinkInstanceBatch>& Pair : LinkInstances)
+	{
+		Pair.Value.Transforms.Reset();
+		Pair.Value.bDirty = bLinkInstancesDirty;
+	}
+
+	for (const TPair<int32, FRegisteredChain>& Pair : Chains)
+	{
+		const AChainInstanceActor* Chain = Pair.Value.Actor.Get();
+		if (Pair.Value.bRestraint || !Chain->UsesInstancedLinks()) continue;
+
+		UStaticMesh* Mesh = Chain->Profile->Visual.LinkMesh;
+		FChainLinkInstanceBatch* Batch = LinkInstances.Find(Mesh);
+		if (!Batch)
+		{
+			Batch = &AddLinkInstanceBatch(Mesh);
+		}
+
+		Batch->Transforms.Append(Chain->LinkTransforms);
+		Batch->bDirty |= Pair.Value.bSteppedThisFrame;
+	}
+
+	// Restraint links are already packed, one range per entity
+	for (int32 Entity = 0; Entity < Restraints.ChainIds.Num(); ++Entity)
+	{
+		UStaticMesh* Mesh = RestraintProfiles[Restraints.ProfileIndices[Entity]]->Visual.LinkMesh;
+		FChainLinkInstanceBatch* Batch = LinkInstances.Find(Mesh);
+		if (!Batch)
+		{
+			Batch = &AddLinkInstanceBatch(Mesh);
+		}
+
+		Batch->Transforms.Append(Restraints.LinkTransforms.GetData() + Restraints.LinkBegins[Entity], Restraints.GetNumLinks(Entity));
+		Batch->bDirty |= Chains[Restraints.ChainIds[Entity]].bSteppedThisFrame;
+	}
+
+	bLinkInstancesDirty = false;
+
+	for (TPair<TObjectPtr<UStaticMesh>, FChainLinkInstanceBatch>& Pair : LinkInstances)
+	{
+		FChainLinkInstanceBatch& Batch = Pair.Value;
+		UInstancedStaticMeshComponent* Component = Batch.Component;
+		if (!Component) continue;
+
+		const int32 NumInstances = Component->GetInstanceCount();
+		if (!Batch.bDirty && NumInstances == Batch.Transforms.Num()) continue;
+
+		// Instances are only added or removed at the end, so existing indices never move
+		if (NumInstances > Batch.Transforms.Num())
+		{
+			TArray<int32> RemovedInstances;
+			for (int32 Index = Batch.Transforms.Num(); Index < NumInstances; ++Index)
+			{
+				RemovedInstances.Add(Index);
+			}
+			Component->RemoveInstances(RemovedInstances);
+		}
+		else if (NumInstances < Batch.Transforms.Num())
+		{
+			const TArray<FTransform> AddedInstances(Batch.Transforms.GetData() + NumInstances, Batch.Transforms.Num() - NumInstances);
+			Component->AddInstances(AddedInstances, false, true, false);
+		}
+
+		if (Batch.Transforms.Num() > 0)
+		{
+			Component->BatchUpdateInstancesTransforms(0, Batch.Transforms, true, true, true);
+		}
+	}
+}
+
+FChainLinkInstanceBatch& UChainSimulationSubsystem::AddLinkInstanceBatch(UStaticMesh* Mesh)
+{
+	if (!InstanceHost)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		InstanceHost = GetWorld()->SpawnActor<AActor>(SpawnParams);
+
+		USceneComponent* Root = NewObject<USceneComponent>(InstanceHost, TEXT("Root"));
+		InstanceHost->SetRootComponent(Root);
+		Root->RegisterComponent();
+	}
+
+	// Render-only: simulation and collision belong to the chains
+	UInstancedStaticMeshComponent* Component = NewObject<UInstancedStaticMeshComponent>(InstanceHost, MakeUniqueObjectName(InstanceHost, UInstancedStaticMeshComponent::StaticClass(), TEXT("LinkInstances")));
+	Component->SetupAttachment(InstanceHost->GetRootComponent());
+	Component->SetMobility(EComponentMobility::Movable);
+	Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Component->SetCanEverAffectNavigation(false);
+	Component->SetStaticMesh(Mesh);
+	Component->RegisterComponent();
+	InstanceHost->AddInstanceComponent(Component);
+
+	FChainLinkInstanceBatch& Batch = LinkInstances.Add(Mesh);
+	Batch.Component = Component;
+	return Batch;
+}
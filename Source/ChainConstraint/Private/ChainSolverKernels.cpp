@@ -0,0 +1,419 @@
+#include "ChainSolverKernels.h"
+#include "ChainParticleBuffer.h"
+#include "Math/VectorRegister.h"
+
+namespace ChainSolverKernels
+{
+namespace Private
+{
+	/** Views over one constraint family (distance or bend) of the buffer. */
+	struct FConstraintArrays
+	{
+		const float* Rest;
+		const float* Compliance;
+		const float* Mask;
+		float* Lambda;
+	};
+
+	/**
+	 * Distance layout: 8 consecutive floats, constraint particles A in even lanes, B in odd lanes.
+	 * Covers constraints Base, Base + 2, Base + 4, Base + 6.
+	 */
+	struct FDistanceLayout
+	{
+		static constexpr int32 ParticleOffset = 1;
+
+		static FORCEINLINE void Load(const float* Src, VectorRegister4Float& OutA, VectorRegister4Float& OutB)
+		{
+			const VectorRegister4Float V0 = VectorLoad(Src);
+			const VectorRegister4Float V1 = VectorLoad(Src + 4);
+			OutA = VectorShuffle(V0, V1, 0, 2, 0, 2);
+			OutB = VectorShuffle(V0, V1, 1, 3, 1, 3);
+		}
+
+		static FORCEINLINE void Store(float* Dst, const VectorRegister4Float& A, const VectorRegister4Float& B)
+		{
+			const VectorRegister4Float Lo = VectorShuffle(A, B, 0, 1, 0, 1);
+			const VectorRegister4Float Hi = VectorShuffle(A, B, 2, 3, 2, 3);
+			VectorStore(VectorSwizzle(Lo, 0, 2, 1, 3), Dst);
+			VectorStore(VectorSwizzle(Hi, 0, 2, 1, 3), Dst + 4);
+		}
+	};
+
+	/**
+	 * Bend layout: 8 consecutive floats, particles A in lanes {0, 1, 4, 5}, B in lanes {2, 3, 6, 7}.
+	 * Covers constraints Base, Base + 1, Base + 4, Base + 5.
+	 */
+	struct FBendLayout
+	{
+		static constexpr int32 ParticleOffset = 2;
+
+		static FORCEINLINE void Load(const float* Src, VectorRegister4Float& OutA, VectorRegister4Float& OutB)
+		{
+			const VectorRegister4Float V0 = VectorLoad(Src);
+			const VectorRegister4Float V1 = VectorLoad(Src + 4);
+			OutA = VectorShuffle(V0, V1, 0, 1, 0, 1);
+			OutB = VectorShuffle(V0, V1, 2, 3, 2, 3);
+		}
+
+		static FORCEINLINE void Store(float* Dst, const VectorRegister4Float& A, const VectorRegister4Float& B)
+		{
+			VectorStore(VectorShuffle(A, B, 0, 1, 0, 1), Dst);
+			VectorStore(VectorShuffle(A, B, 2, 3, 2, 3), Dst + 4);
+		}
+	};
+
+	/** Parameters of the closest points of segments [P0, P1] and [Q0, Q1]. */
+	FORCEINLINE void ClosestSegmentParams(const FVector3f& P0, const FVector3f& P1, const FVector3f& Q0, const FVector3f& Q1, float& OutS, float& OutT)
+	{
+		const FVector3f D1 = P1 - P0;
+		const FVector3f D2 = Q1 - Q0;
+		const FVector3f R = P0 - Q0;
+		const float A = D1.SizeSquared();
+		const float E = D2.SizeSquared();
+		const float F = FVector3f::DotProduct(D2, R);
+		const float C = FVector3f::DotProduct(D1, R);
+		const float B = FVector3f::DotProduct(D1, D2);
+		const float Denominator = A * E - B * B;
+
+		// Parallel segments: any point of the first one will do
+		OutS = Denominator > UE_SMALL_NUMBER ? FMath::Clamp((B * F - C * E) / Denominator, 0.0f, 1.0f) : 0.0f;
+		OutT = E > UE_SMALL_NUMBER ? (B * OutS + F) / E : 0.0f;
+
+		if (OutT < 0.0f)
+		{
+			OutT = 0.0f;
+			OutS = A > UE_SMALL_NUMBER ? FMath::Clamp(-C / A, 0.0f, 1.0f) : 0.0f;
+		}
+		else if (OutT > 1.0f)
+		{
+			OutT = 1.0f;
+			OutS = A > UE_SMALL_NUMBER ? FMath::Clamp((B - C) / A, 0.0f, 1.0f) : 0.0f;
+		}
+	}
+
+	/** Projects the four constraints of one block. */
+	template <typename LayoutType>
+	FORCEINLINE void SolveBlock(FChainParticleBuffer& Buffer, const FConstraintArrays& Constraints, int32 Base, const VectorRegister4Float& InvDeltaTimeSq)
+	{
+		const VectorRegister4Float Zero = VectorZeroFloat();
+		const VectorRegister4Float SmallLengthSq = VectorSetFloat1(UE_KINDA_SMALL_NUMBER * UE_KINDA_SMALL_NUMBER);
+
+		VectorRegister4Float AX, AY, AZ, BX, BY, BZ, WA, WB;
+		LayoutType::Load(Buffer.PosX.GetData() + Base, AX, BX);
+		LayoutType::Load(Buffer.PosY.GetData() + Base, AY, BY);
+		LayoutType::Load(Buffer.PosZ.GetData() + Base, AZ, BZ);
+		LayoutType::Load(Buffer.InvMass.GetData() + Base, WA, WB);
+
+		// Only the A lanes of the constraint arrays belong to this color
+		VectorRegister4Float Rest, Compliance, Mask, Lambda, Unused, OtherLambda;
+		LayoutType::Load(Constraints.Rest + Base, Rest, Unused);
+		LayoutType::Load(Constraints.Compliance + Base, Compliance, Unused);
+		LayoutType::Load(Constraints.Mask + Base, Mask, Unused);
+		LayoutType::Load(Constraints.Lambda + Base, Lambda, OtherLambda);
+
+		const VectorRegister4Float DX = VectorSubtract(BX, AX);
+		const VectorRegister4Float DY = VectorSubtract(BY, AY);
+		const VectorRegister4Float DZ = VectorSubtract(BZ, AZ);
+		const VectorRegister4Float LengthSq = VectorMultiplyAdd(DX, DX, VectorMultiplyAdd(DY, DY, VectorMultiply(DZ, DZ)));
+		const VectorRegister4Float Length = VectorSqrt(VectorMax(LengthSq, SmallLengthSq));
+
+		const VectorRegister4Float C = VectorSubtract(Length, Rest);
+		const VectorRegister4Float Alpha = VectorMultiply(Compliance, InvDeltaTimeSq);
+		const VectorRegister4Float WSum = VectorAdd(WA, WB);
+		const VectorRegister4Float Denominator = VectorMax(VectorAdd(WSum, Alpha), SmallLengthSq);
+
+		// Masked lanes (padding, chain boundaries) and lanes between two pinned particles do nothing
+		const VectorRegister4Float Active = VectorBitwiseAnd(VectorCompareGT(Mask, Zero), VectorCompareGT(WSum, Zero));
+		VectorRegister4Float DeltaLambda = VectorDivide(VectorNegate(VectorMultiplyAdd(Alpha, Lambda, C)), Denominator);
+		DeltaLambda = VectorSelect(Active, DeltaLambda, Zero);
+		Lambda = VectorAdd(Lambda, DeltaLambda);
+
+		const VectorRegister4Float Scale = VectorDivide(DeltaLambda, Length);
+		const VectorRegister4Float ScaleA = VectorMultiply(WA, Scale);
+		const VectorRegister4Float ScaleB = VectorMultiply(WB, Scale);
+
+		AX = VectorNegMultiplyAdd(ScaleA, DX, AX);
+		AY = VectorNegMultiplyAdd(ScaleA, DY, AY);
+		AZ = VectorNegMultiplyAdd(ScaleA, DZ, AZ);
+		BX = VectorMultiplyAdd(ScaleB, DX, BX);
+		BY = VectorMultiplyAdd(ScaleB, DY, BY);
+		BZ = VectorMultiplyAdd(ScaleB, DZ, BZ);
+
+		LayoutType::Store(Buffer.PosX.GetData() + Base, AX, BX);
+		LayoutType::Store(Buffer.PosY.GetData() + Base, AY, BY);
+		LayoutType::Store(Buffer.PosZ.GetData() + Base, AZ, BZ);
+		LayoutType::Store(Constraints.Lambda + Base, Lambda, OtherLambda);
+	}
+
+	/** Scalar version of SolveBlock for the tail of a range. */
+	FORCEINLINE void SolveScalar(FChainParticleBuffer& Buffer, const FConstraintArrays& Constraints, int32 Index, int32 ParticleOffset, float InvDeltaTimeSq)
+	{
+		const int32 IndexB = Index + ParticleOffset;
+		const float WA = Buffer.InvMass[Index];
+		const float WB = Buffer.InvMass[IndexB];
+		const float WSum = WA + WB;
+		if (Constraints.Mask[Index] <= 0.0f || WSum <= 0.0f)
+		{
+			return;
+		}
+
+		const FVector3f Delta = Buffer.GetPosition(IndexB) - Buffer.GetPosition(Index);
+		const float Length = FMath::Max(Delta.Size(), UE_KINDA_SMALL_NUMBER);
+		const float Alpha = Constraints.Compliance[Index] * InvDeltaTimeSq;
+		const float C = Length - Constraints.Rest[Index];
+		const float DeltaLambda = -(C + Alpha * Constraints.Lambda[Index]) / (WSum + Alpha);
+		Constraints.Lambda[Index] += DeltaLambda;
+
+		const FVector3f Correction = Delta * (DeltaLambda / Length);
+		Buffer.SetPosition(Index, Buffer.GetPosition(Index) - Correction * WA);
+		Buffer.SetPosition(IndexB, Buffer.GetPosition(IndexB) + Correction * WB);
+	}
+
+	/**
+	 * Runs both colors of a constraint family over [Begin, End).
+	 * ColorOffset is the distance between the first block of each color; LaneOffsets lists the
+	 * constraints of one block relative to its base (used for the scalar tail).
+	 */
+	template <typename LayoutType>
+	void SolveFamily(FChainParticleBuffer& Buffer, const FConstraintArrays& Constraints, int32 Begin, int32 End, int32 ColorOffset, const int32 (&LaneOffsets)[4], float InvDeltaTimeSq)
+	{
+		const VectorRegister4Float InvDeltaTimeSqV = VectorSetFloat1(InvDeltaTimeSq);
+
+		for (int32 Color = 0; Color < 2; ++Color)
+		{
+			int32 Base = Begin + Color * ColorOffset;
+			for (; Base + ChainParticleBlockSize <= End; Base += ChainParticleBlockSize)
+			{
+				SolveBlock<LayoutType>(Buffer, Constraints, Base, InvDeltaTimeSqV);
+			}
+
+			// The second color ends with a partial block: never touch particles past End
+			for (const int32 LaneOffset : LaneOffsets)
+			{
+				const int32 Index = Base + LaneOffset;
+				if (Index + LayoutType::ParticleOffset < End)
+				{
+					SolveScalar(Buffer, Constraints, Index, LayoutType::ParticleOffset, InvDeltaTimeSq);
+				}
+			}
+		}
+	}
+}
+
+void Integrate(FChainParticleBuffer& Buffer, int32 Begin, int32 End, const FVector3f& Gravity, float DeltaTime)
+{
+	const VectorRegister4Float Zero = VectorZeroFloat();
+	const VectorRegister4Float One = VectorOneFloat();
+	const VectorRegister4Float Dt = VectorSetFloat1(DeltaTime);
+	const VectorRegister4Float GX = VectorSetFloat1(Gravity.X * DeltaTime);
+	const VectorRegister4Float GY = VectorSetFloat1(Gravity.Y * DeltaTime);
+	const VectorRegister4Float GZ = VectorSetFloat1(Gravity.Z * DeltaTime);
+
+	for (int32 i = Begin; i < End; i += 4)
+	{
+		const VectorRegister4Float Movable = VectorCompareGT(VectorLoadAligned(&Buffer.InvMass[i]), Zero);
+		const VectorRegister4Float GravityScale = VectorLoadAligned(&Buffer.GravityScale[i]);
+		const VectorRegister4Float DampingFactor = VectorMax(Zero, VectorNegMultiplyAdd(VectorLoadAligned(&Buffer.Damping[i]), Dt, One));
+
+		const VectorRegister4Float OldVX = VectorLoadAligned(&Buffer.VelX[i]);
+		const VectorRegister4Float OldVY = VectorLoadAligned(&Buffer.VelY[i]);
+		const VectorRegister4Float OldVZ = VectorLoadAligned(&Buffer.VelZ[i]);
+
+		// Pinned particles move on at their kinematic velocity, free of gravity and damping
+		VectorRegister4Float VX = VectorMultiply(VectorMultiplyAdd(GX, GravityScale, OldVX), DampingFactor);
+		VectorRegister4Float VY = VectorMultiply(VectorMultiplyAdd(GY, GravityScale, OldVY), DampingFactor);
+		VectorRegister4Float VZ = VectorMultiply(VectorMultiplyAdd(GZ, GravityScale, OldVZ), DampingFactor);
+		VX = VectorSelect(Movable, VX, OldVX);
+		VY = VectorSelect(Movable, VY, OldVY);
+		VZ = VectorSelect(Movable, VZ, OldVZ);
+
+		const VectorRegister4Float PX = VectorLoadAligned(&Buffer.PosX[i]);
+		const VectorRegister4Float PY = VectorLoadAligned(&Buffer.PosY[i]);
+		const VectorRegister4Float PZ = VectorLoadAligned(&Buffer.PosZ[i]);
+		VectorStoreAligned(PX, &Buffer.PrevX[i]);
+		VectorStoreAligned(PY, &Buffer.PrevY[i]);
+		VectorStoreAligned(PZ, &Buffer.PrevZ[i]);
+
+		VectorStoreAligned(VectorMultiplyAdd(VX, Dt, PX), &Buffer.PosX[i]);
+		VectorStoreAligned(VectorMultiplyAdd(VY, Dt, PY), &Buffer.PosY[i]);
+		VectorStoreAligned(VectorMultiplyAdd(VZ, Dt, PZ), &Buffer.PosZ[i]);
+		VectorStoreAligned(VX, &Buffer.VelX[i]);
+		VectorStoreAligned(VY, &Buffer.VelY[i]);
+		VectorStoreAligned(VZ, &Buffer.VelZ[i]);
+	}
+}
+
+void ResetLambdas(FChainParticleBuffer& Buffer, int32 Begin, int32 End)
+{
+	FMemory::Memzero(Buffer.DistanceLambda.GetData() + Begin, (End - Begin) * sizeof(float));
+	FMemory::Memzero(Buffer.BendLambda.GetData() + Begin, (End - Begin) * sizeof(float));
+}
+
+void SolveDistanceConstraints(FChainParticleBuffer& Buffer, int32 Begin, int32 End, float InvDeltaTimeSq)
+{
+	static constexpr int32 LaneOffsets[4] = { 0, 2, 4, 6 };
+
+	const Private::FConstraintArrays Constraints = {
+		Buffer.DistanceRest.GetData(), Buffer.DistanceCompliance.GetData(), Buffer.DistanceMask.GetData(), Buffer.DistanceLambda.GetData() };
+
+	Private::SolveFamily<Private::FDistanceLayout>(Buffer, Constraints, Begin, End, 1, LaneOffsets, InvDeltaTimeSq);
+}
+
+void SolveBendConstraints(FChainParticleBuffer& Buffer, int32 Begin, int32 End, float InvDeltaTimeSq)
+{
+	static constexpr int32 LaneOffsets[4] = { 0, 1, 4, 5 };
+
+	const Private::FConstraintArrays Constraints = {
+		Buffer.BendRest.GetData(), Buffer.BendCompliance.GetData(), Buffer.BendMask.GetData(), Buffer.BendLambda.GetData() };
+
+	Private::SolveFamily<Private::FBendLayout>(Buffer, Constraints, Begin, End, 2, LaneOffsets, InvDeltaTimeSq);
+}
+
+void SolveTethers(FChainParticleBuffer& Buffer, int32 Begin, int32 End)
+{
+	const VectorRegister4Float Zero = VectorZeroFloat();
+	const VectorRegister4Float SmallLengthSq = VectorSetFloat1(UE_KINDA_SMALL_NUMBER * UE_KINDA_SMALL_NUMBER);
+
+	for (int32 i = Begin; i < End; i += 4)
+	{
+		const VectorRegister4Float MaxDistance = VectorLoadAligned(&Buffer.TetherRest[i]);
+		const VectorRegister4Float Tethered = VectorBitwiseAnd(VectorCompareGT(MaxDistance, Zero), VectorCompareGT(VectorLoadAligned(&Buffer.InvMass[i]), Zero));
+		if (VectorMaskBits(Tethered) == 0)
+		{
+			continue;
+		}
+
+		// Anchors are gathered, untethered lanes still point at a valid particle
+		const int32* Anchor = &Buffer.TetherAnchor[i];
+		const VectorRegister4Float AX = MakeVectorRegisterFloat(Buffer.PosX[Anchor[0]], Buffer.PosX[Anchor[1]], Buffer.PosX[Anchor[2]], Buffer.PosX[Anchor[3]]);
+		const VectorRegister4Float AY = MakeVectorRegisterFloat(Buffer.PosY[Anchor[0]], Buffer.PosY[Anchor[1]], Buffer.PosY[Anchor[2]], Buffer.PosY[Anchor[3]]);
+		const VectorRegister4Float AZ = MakeVectorRegisterFloat(Buffer.PosZ[Anchor[0]], Buffer.PosZ[Anchor[1]], Buffer.PosZ[Anchor[2]], Buffer.PosZ[Anchor[3]]);
+
+		const VectorRegister4Float PX = VectorLoadAligned(&Buffer.PosX[i]);
+		const VectorRegister4Float PY = VectorLoadAligned(&Buffer.PosY[i]);
+		const VectorRegister4Float PZ = VectorLoadAligned(&Buffer.PosZ[i]);
+		const VectorRegister4Float DX = VectorSubtract(PX, AX);
+		const VectorRegister4Float DY = VectorSubtract(PY, AY);
+		const VectorRegister4Float DZ = VectorSubtract(PZ, AZ);
+		const VectorRegister4Float LengthSq = VectorMultiplyAdd(DX, DX, VectorMultiplyAdd(DY, DY, VectorMultiply(DZ, DZ)));
+		const VectorRegister4Float Length = VectorSqrt(VectorMax(LengthSq, SmallLengthSq));
+
+		// Unilateral: only stretched tethers pull
+		const VectorRegister4Float Stretched = VectorBitwiseAnd(Tethered, VectorCompareGT(Length, MaxDistance));
+		const VectorRegister4Float Scale = VectorDivide(MaxDistance, Length);
+
+		VectorStoreAligned(VectorSelect(Stretched, VectorMultiplyAdd(DX, Scale, AX), PX), &Buffer.PosX[i]);
+		VectorStoreAligned(VectorSelect(Stretched, VectorMultiplyAdd(DY, Scale, AY), PY), &Buffer.PosY[i]);
+		VectorStoreAligned(VectorSelect(Stretched, VectorMultiplyAdd(DZ, Scale, AZ), PZ), &Buffer.PosZ[i]);
+	}
+}
+
+void SolveContacts(FChainParticleBuffer& Buffer, int32 Begin, int32 End)
+{
+	const VectorRegister4Float Zero = VectorZeroFloat();
+
+	for (int32 Base = Begin; Base < End; Base += 4)
+	{
+		// Contacts are sparse: skip whole blocks without any, solve the others one segment at a time
+		if (VectorMaskBits(VectorCompareGT(VectorLoadAligned(&Buffer.ContactMask[Base]), Zero)) == 0)
+		{
+			continue;
+		}
+
+		for (int32 Index = Base; Index < Base + 4; ++Index)
+		{
+			if (Buffer.ContactMask[Index] <= 0.0f) continue;
+
+			const int32 IndexB = Index + 1;
+			const float T = Buffer.ContactParam[Index];
+			const float WA = Buffer.InvMass[Index] * (1.0f - T);
+			const float WB = Buffer.InvMass[IndexB] * T;
+			const float Denominator = (1.0f - T) * WA + T * WB;
+			if (Denominator <= UE_SMALL_NUMBER) continue;
+
+			const FVector3f Normal(Buffer.ContactNX[Index], Buffer.ContactNY[Index], Buffer.ContactNZ[Index]);
+			const FVector3f A = Buffer.GetPosition(Index);
+			const FVector3f B = Buffer.GetPosition(IndexB);
+			const float Penetration = Buffer.ContactOffset[Index] - FVector3f::DotProduct(FMath::Lerp(A, B, T), Normal);
+			if (Penetration <= 0.0f) continue;
+
+			// Normal correction moves the contact point by exactly Penetration along the normal
+			FVector3f Correction = Normal * Penetration;
+
+			// Friction removes the tangential motion of the contact point, up to Friction x the normal correction
+			const FVector3f PrevA(Buffer.PrevX[Index], Buffer.PrevY[Index], Buffer.PrevZ[Index]);
+			const FVector3f PrevB(Buffer.PrevX[IndexB], Buffer.PrevY[IndexB], Buffer.PrevZ[IndexB]);
+			const FVector3f Motion = FMath::Lerp(A, B, T) + Correction - FMath::Lerp(PrevA, PrevB, T);
+			const FVector3f Tangential = Motion - Normal * FVector3f::DotProduct(Motion, Normal);
+			const float TangentialLength = Tangential.Size();
+			if (TangentialLength > UE_KINDA_SMALL_NUMBER)
+			{
+				const float MaxFriction = Buffer.ContactFriction[Index] * Penetration;
+				Correction -= Tangential * FMath::Min(1.0f, MaxFriction / TangentialLength);
+			}
+
+			Buffer.SetPosition(Index, A + Correction * (WA / Denominator));
+			Buffer.SetPosition(IndexB, B + Correction * (WB / Denominator));
+		}
+	}
+}
+
+void SolveSegmentPairs(FChainParticleBuffer& Buffer, TConstArrayView<FChainSegmentPair> Pairs)
+{
+	for (const FChainSegmentPair& Pair : Pairs)
+	{
+		const int32 A0 = Pair.A;
+		const int32 A1 = Pair.A + 1;
+		const int32 B0 = Pair.B;
+		const int32 B1 = Pair.B + 1;
+		const FVector3f PA0 = Buffer.GetPosition(A0);
+		const FVector3f PA1 = Buffer.GetPosition(A1);
+		const FVector3f PB0 = Buffer.GetPosition(B0);
+		const FVector3f PB1 = Buffer.GetPosition(B1);
+
+		float S, T;
+		Private::ClosestSegmentParams(PA0, PA1, PB0, PB1, S, T);
+
+		const FVector3f Delta = FMath::Lerp(PA0, PA1, S) - FMath::Lerp(PB0, PB1, T);
+		const float DistanceSq = Delta.SizeSquared();
+		if (DistanceSq >= FMath::Square(Pair.MinDistance) || DistanceSq <= UE_SMALL_NUMBER) continue;
+
+		const float WA0 = Buffer.InvMass[A0] * (1.0f - S);
+		const float WA1 = Buffer.InvMass[A1] * S;
+		const float WB0 = Buffer.InvMass[B0] * (1.0f - T);
+		const float WB1 = Buffer.InvMass[B1] * T;
+		const float Denominator = (1.0f - S) * WA0 + S * WA1 + (1.0f - T) * WB0 + T * WB1;
+		if (Denominator <= UE_SMALL_NUMBER) continue;
+
+		// Moves the closest points apart by exactly the missing distance
+		const float Distance = FMath::Sqrt(DistanceSq);
+		const FVector3f Correction = Delta * ((Pair.MinDistance - Distance) / (Distance * Denominator));
+
+		Buffer.SetPosition(A0, PA0 + Correction * WA0);
+		Buffer.SetPosition(A1, PA1 + Correction * WA1);
+		Buffer.SetPosition(B0, PB0 - Correction * WB0);
+		Buffer.SetPosition(B1, PB1 - Correction * WB1);
+	}
+}
+
+void UpdateVelocities(FChainParticleBuffer& Buffer, int32 Begin, int32 End, float InvDeltaTime)
+{
+	const VectorRegister4Float Zero = VectorZeroFloat();
+	const VectorRegister4Float InvDt = VectorSetFloat1(InvDeltaTime);
+
+	for (int32 i = Begin; i < End; i += 4)
+	{
+		const VectorRegister4Float Movable = VectorCompareGT(VectorLoadAligned(&Buffer.InvMass[i]), Zero);
+
+		const VectorRegister4Float VX = VectorMultiply(VectorSubtract(VectorLoadAligned(&Buffer.PosX[i]), VectorLoadAligned(&Buffer.PrevX[i])), InvDt);
+		const VectorRegister4Float VY = VectorMultiply(VectorSubtract(VectorLoadAligned(&Buffer.PosY[i]), VectorLoadAligned(&Buffer.PrevY[i])), InvDt);
+		const VectorRegister4Float VZ = VectorMultiply(VectorSubtract(VectorLoadAligned(&Buffer.PosZ[i]), VectorLoadAligned(&Buffer.PrevZ[i])), InvDt);
+
+		// Pinned particles keep the kinematic velocity they were given
+		VectorStoreAligned(VectorSelect(Movable, VX, VectorLoadAligned(&Buffer.VelX[i])), &Buffer.VelX[i]);
+		VectorStoreAligned(VectorSelect(Movable, VY, VectorLoadAligned(&Buffer.VelY[i])), &Buffer.VelY[i]);
+		VectorStoreAligned(VectorSelect(Movable, VZ, VectorLoadAligned(&Buffer.VelZ[i])), &Buffer.VelZ[i]);
+	}
+}
+}
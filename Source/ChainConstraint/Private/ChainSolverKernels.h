@@ -0,0 +1,42 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FChainParticleBuffer;
+struct FChainSegmentPair;
+
+/**
+ * SIMD kernels operating on a block aligned particle range [Begin, End) of a FChainParticleBuffer.
+ * A range may span several chains: chain boundaries are handled by the constraint masks.
+ * Constraints are split in independent colors (even / odd for distance, pairs of two for bend)
+ * and each color is projected four constraints at a time.
+ */
+namespace ChainSolverKernels
+{
+	/** Applies gravity and damping, saves previous positions and predicts new positions. Pinned particles move at their velocity. */
+	void Integrate(FChainParticleBuffer& Buffer, int32 Begin, int32 End, const FVector3f& Gravity, float DeltaTime);
+
+	/** Clears the XPBD multipliers at the start of a step. */
+	void ResetLambdas(FChainParticleBuffer& Buffer, int32 Begin, int32 End);
+
+	/** One Gauss-Seidel pass over the distance constraints. */
+	void SolveDistanceConstraints(FChainParticleBuffer& Buffer, int32 Begin, int32 End, float InvDeltaTimeSq);
+
+	/** One Gauss-Seidel pass over the bend constraints. */
+	void SolveBendConstraints(FChainParticleBuffer& Buffer, int32 Begin, int32 End, float InvDeltaTimeSq);
+
+	/** Pulls particles farther than their tether rest length back towards their anchor. Anchors never move. */
+	void SolveTethers(FChainParticleBuffer& Buffer, int32 Begin, int32 End);
+
+	/**
+	 * Pushes the segment capsules out of their world contact planes, with Coulomb friction
+	 * against the motion of the contact point since the start of the step.
+	 */
+	void SolveContacts(FChainParticleBuffer& Buffer, int32 Begin, int32 End);
+
+	/** Pushes apart the closest points of every pair of segments closer than the pair's MinDistance. */
+	void SolveSegmentPairs(FChainParticleBuffer& Buffer, TConstArrayView<FChainSegmentPair> Pairs);
+
+	/** Derives velocities of the free particles from the corrected positions. */
+	void UpdateVelocities(FChainParticleBuffer& Buffer, int32 Begin, int32 End, float InvDeltaTime);
+}
@@ -0,0 +1,59 @@
+#include "ChainSpatialHash.h"
+
+bool FChainSpatialHash::Build(TConstArrayView<FVector3f> Points, float InCellSize)
+{
+	const float NewCellSize = FMath::Max(InCellSize, UE_KINDA_SMALL_NUMBER);
+	bool bChanged = BucketStarts.Num() == 0 || NewCellSize != CellSize || Points.Num() != ItemCells.Num();
+
+	CellSize = NewCellSize;
+	InvCellSize = 1.0f / NewCellSize;
+
+	ItemCells.SetNum(Points.Num());
+	for (int32 Index = 0; Index < Points.Num(); ++Index)
+	{
+		const FIntVector Cell = GetCell(Points[Index]);
+		bChanged |= Cell != ItemCells[Index];
+		ItemCells[Index] = Cell;
+	}
+
+	if (!bChanged)
+	{
+		return false;
+	}
+
+	// Counting sort of the items by bucket, about two buckets per item
+	const int32 NumBuckets = static_cast<int32>(FMath::RoundUpToPowerOfTwo(static_cast<uint32>(FMath::Max(2 * Points.Num(), 16))));
+	BucketMask = static_cast<uint32>(NumBuckets - 1);
+
+	BucketStarts.Reset();
+	BucketStarts.SetNumZeroed(NumBuckets + 1);
+	for (const FIntVector& Cell : ItemCells)
+	{
+		++BucketStarts[GetBucket(Cell) + 1];
+	}
+	for (int32 Bucket = 1; Bucket <= NumBuckets; ++Bucket)
+	{
+		BucketStarts[Bucket] += BucketStarts[Bucket - 1];
+	}
+
+	// Filling moves each start to the next bucket's start, shift them back afterwards
+	Items.SetNumUninitialized(Points.Num());
+	for (int32 Index = 0; Index < ItemCells.Num(); ++Index)
+	{
+		Items[BucketStarts[GetBucket(ItemCells[Index])]++] = Index;
+	}
+	for (int32 Bucket = NumBuckets; Bucket > 0; --Bucket)
+	{
+		BucketStarts[Bucket] = BucketStarts[Bucket - 1];
+	}
+	BucketStarts[0] = 0;
+
+	return true;
+}
+
+void FChainSpatialHash::Reset()
+{
+	BucketStarts.Reset();
+	Items.Reset();
+	ItemCells.Reset();
+}
@@ -0,0 +1,18 @@
+#include "ChainStats.h"
+
+DEFINE_STAT(STAT_ChainActiveChains);
+DEFINE_STAT(STAT_ChainActiveLinks);
+DEFINE_STAT(STAT_ChainSleepingChains);
+DEFINE_STAT(STAT_ChainRebuilds);
+DEFINE_STAT(STAT_ChainBudgetDegraded);
+DEFINE_STAT(STAT_ChainWorldContacts);
+DEFINE_STAT(STAT_ChainCrossPairs);
+DEFINE_STAT(STAT_ChainTrackedAnchors);
+DEFINE_STAT(STAT_ChainReplicatedBytes);
+
+DEFINE_STAT(STAT_ChainGather);
+DEFINE_STAT(STAT_ChainWorldCollision);
+DEFINE_STAT(STAT_ChainSolve);
+DEFINE_STAT(STAT_ChainWriteBack);
+DEFINE_STAT(STAT_ChainInstanceUpload);
+DEFINE_STAT(STAT_ChainBuild);
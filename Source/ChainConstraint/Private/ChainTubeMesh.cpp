@@ -0,0 +1,120 @@
+#include "ChainTubeMesh.h"
+
+/** Uniform Catmull-Rom interpolation between P1 and P2. */
+static FVector CatmullRom(const FVector& P0, const FVector& P1, const FVector& P2, const FVector& P3, float T)
+{
+	const float T2 = T * T;
+	const float T3 = T2 * T;
+	return 0.5f * ((2.0f * P1) + (P2 - P0) * T + (2.0f * P0 - 5.0f * P1 + 4.0f * P2 - P3) * T2 + (3.0f * P1 - P0 - 3.0f * P2 + P3) * T3);
+}
+
+bool FChainTubeMesh::Build(TConstArrayView<FVector> Points, float Radius, int32 RadialSegments, int32 Subdivisions)
+{
+	const int32 NumPoints = Points.Num();
+	if (NumPoints < 2)
+	{
+		const bool bHadGeometry = NumRings > 0;
+		Reset();
+		return bHadGeometry;
+	}
+
+	RadialSegments = FMath::Max(3, RadialSegments);
+	Subdivisions = FMath::Max(1, Subdivisions);
+
+	const int32 Rings = (NumPoints - 1) * Subdivisions + 1;
+	const int32 RingVertices = RadialSegments + 1; // Seam vertex duplicated for the UVs
+	const bool bTopologyChanged = Rings != NumRings || RadialSegments != NumRadialSegments;
+
+	// Ring centers
+	Centers.SetNumUninitialized(Rings, EAllowShrinking::No);
+	for (int32 Segment = 0; Segment < NumPoints - 1; ++Segment)
+	{
+		const FVector& P0 = Points[FMath::Max(Segment - 1, 0)];
+		const FVector& P1 = Points[Segment];
+		const FVector& P2 = Points[Segment + 1];
+		const FVector& P3 = Points[FMath::Min(Segment + 2, NumPoints - 1)];
+
+		for (int32 Sub = 0; Sub < Subdivisions; ++Sub)
+		{
+			Centers[Segment * Subdivisions + Sub] = CatmullRom(P0, P1, P2, P3, static_cast<float>(Sub) / Subdivisions);
+		}
+	}
+	Centers[Rings - 1] = Points.Last();
+
+	// Vertices, with a frame carried from ring to ring
+	const int32 NumVertices = Rings * RingVertices;
+	Vertices.SetNumUninitialized(NumVertices, EAllowShrinking::No);
+	Normals.SetNumUninitialized(NumVertices, EAllowShrinking::No);
+	UVs.SetNumUninitialized(NumVertices, EAllowShrinking::No);
+	Tangents.SetNumUninitialized(NumVertices, EAllowShrinking::No);
+
+	const float Circumference = UE_TWO_PI * Radius;
+	float Distance = 0.0f;
+	FVector Normal = FVector::ZeroVector;
+
+	for (int32 Ring = 0; Ring < Rings; ++Ring)
+	{
+		const FVector& Prev = Centers[FMath::Max(Ring - 1, 0)];
+		const FVector& Next = Centers[FMath::Min(Ring + 1, Rings - 1)];
+		const FVector Direction = (Next - Prev).GetSafeNormal(UE_SMALL_NUMBER, FVector::ForwardVector);
+
+		if (Ring == 0)
+		{
+			const FVector Reference = FMath::Abs(Direction.Z) < 0.99f ? FVector::UpVector : FVector::ForwardVector;
+			Normal = FVector::CrossProduct(Reference, Direction).GetSafeNormal();
+		}
+		else
+		{
+			Distance += FVector::Dist(Centers[Ring - 1], Centers[Ring]);
+			Normal = (Normal - Direction * FVector::DotProduct(Normal, Direction)).GetSafeNormal(UE_SMALL_NUMBER, FVector::CrossProduct(FVector::UpVector, Direction).GetSafeNormal());
+		}
+		const FVector Binormal = FVector::CrossProduct(Direction, Normal);
+
+		const float V = Distance / Circumference;
+		for (int32 Side = 0; Side < RingVertices; ++Side)
+		{
+			float Sin, Cos;
+			FMath::SinCos(&Sin, &Cos, UE_TWO_PI * Side / RadialSegments);
+
+			const FVector Outward = Normal * Cos + Binormal * Sin;
+			const int32 Vertex = Ring * RingVertices + Side;
+			Vertices[Vertex] = Centers[Ring] + Outward * Radius;
+			Normals[Vertex] = Outward;
+			UVs[Vertex] = FVector2D(static_cast<float>(Side) / RadialSegments, V);
+			Tangents[Vertex] = FProcMeshTangent(Binormal * Cos - Normal * Sin, false);
+		}
+	}
+
+	if (bTopologyChanged)
+	{
+		Triangles.Reset((Rings - 1) * RadialSegments * 6);
+		for (int32 Ring = 0; Ring < Rings - 1; ++Ring)
+		{
+			for (int32 Side = 0; Side < RadialSegments; ++Side)
+			{
+				const int32 A = Ring * RingVertices + Side;
+				const int32 B = A + RingVertices;
+
+				Triangles.Append({ A, B, A + 1 });
+				Triangles.Append({ A + 1, B, B + 1 });
+			}
+		}
+
+		NumRings = Rings;
+		NumRadialSegments = RadialSegments;
+	}
+
+	return bTopologyChanged;
+}
+
+void FChainTubeMesh::Reset()
+{
+	Vertices.Empty();
+	Normals.Empty();
+	UVs.Empty();
+	Tangents.Empty();
+	Triangles.Empty();
+	Centers.Empty();
+	NumRings = 0;
+	NumRadialSegments = 0;
+}
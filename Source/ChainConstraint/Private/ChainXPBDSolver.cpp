@@ -0,0 +1,682 @@
+#include "ChainXPBDSolver.h"
+#include "ChainSolverKernels.h"
+#include "Algo/BinarySearch.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+int32 FChainXPBDSolver::AddChain(TConstArrayView<FVector> InPositions, const FChainSolverChainSettings& Settings)
+{
+	const int32 NumParticles = InPositions.Num();
+	if (NumParticles < 2)
+	{
+		return INDEX_NONE;
+	}
+
+	RecordCommand([Positions = TArray<FVector>(InPositions.GetData(), InPositions.Num()), Settings](FChainXPBDSolver& Mirror)
+	{
+		Mirror.AddChain(Positions, Settings);
+	});
+	TGuardValue<TArray<FChainSolverCommand>*> SuspendRecording(RecordedCommands, nullptr);
+
+	// Particles sit at the end of the range, the head room in front is used to insert particles at the start
+	FChainRange Range;
+	Range.NumParticles = NumParticles;
+	Range.Capacity = Align(FMath::Max(NumParticles, Settings.MaxParticles), ChainParticleBlockSize);
+	Range.Begin = AllocateRange(Range.Capacity);
+	Range.Head = Range.Capacity - NumParticles;
+	Range.Revision = ++NextRevision;
+
+	const int32 First = Range.First();
+	for (int32 i = 0; i < NumParticles; ++i)
+	{
+		const FVector3f Position(InPositions[i]);
+		Buffer.SetPosition(First + i, Position);
+		Buffer.SetPrevPosition(First + i, Position);
+		Buffer.SetVelocity(First + i, FVector3f::ZeroVector);
+		Buffer.InvMass[First + i] = 1.0f; // Free until pinned, actual value set by ConfigureChain
+	}
+
+	// Rest lengths come from the initial layout
+	for (int32 i = 0; i < NumParticles - 1; ++i)
+	{
+		Buffer.DistanceRest[First + i] = FVector3f::Dist(Buffer.GetPosition(First + i), Buffer.GetPosition(First + i + 1));
+		Buffer.DistanceMask[First + i] = 1.0f;
+	}
+	for (int32 i = 0; i < NumParticles - 2; ++i)
+	{
+		Buffer.BendRest[First + i] = FVector3f::Dist(Buffer.GetPosition(First + i), Buffer.GetPosition(First + i + 2));
+	}
+
+	const int32 ChainId = Chains.Add(Range);
+	ConfigureChain(ChainId, Settings);
+
+	return ChainId;
+}
+
+void FChainXPBDSolver::RemoveChain(int32 ChainId)
+{
+	if (!Chains.IsValidIndex(ChainId)) return;
+
+	RecordCommand([ChainId](FChainXPBDSolver& Mirror) { Mirror.RemoveChain(ChainId); });
+
+	SelfCollisions.RemoveAll([ChainId](const FChainSelfCollision& SelfCollision) { return SelfCollision.ChainId == ChainId; });
+
+	const FChainRange Range = Chains[ChainId];
+	Chains.RemoveAt(ChainId);
+	ReleaseRange(Range.Begin, Range.Capacity);
+}
+
+void FChainXPBDSolver::Reset()
+{
+	RecordCommand([](FChainXPBDSolver& Mirror) { Mirror.Reset(); });
+
+	Buffer.Empty();
+	Chains.Empty();
+	FreeRanges.Empty();
+	SelfCollisions.Empty();
+}
+
+bool FChainXPBDSolver::ResizeChain(int32 ChainId, TConstArrayView<FVector3f> Positions, TConstArrayView<FVector3f> Velocities, float RestLength)
+{
+	if (!Chains.IsValidIndex(ChainId)) return false;
+
+	FChainRange& Range = Chains[ChainId];
+	const int32 NumParticles = Positions.Num();
+	if (NumParticles < 2 || NumParticles > Range.Capacity || Velocities.Num() != NumParticles) return false;
+
+	RecordCommand([ChainId, Positions = TArray<FVector3f>(Positions.GetData(), Positions.Num()), Velocities = TArray<FVector3f>(Velocities.GetData(), Velocities.Num()), RestLength](FChainXPBDSolver& Mirror)
+	{
+		Mirror.ResizeChain(ChainId, Positions, Velocities, RestLength);
+	});
+
+	// Per chain parameters are uniform over the range, keep those of the current start particle
+	const int32 OldFirst = Range.First();
+	const bool bStartPinned = Buffer.InvMass[OldFirst] == 0.0f;
+	const bool bEndPinned = Buffer.InvMass[Range.Last()] == 0.0f;
+	const float GravityScale = Buffer.GravityScale[OldFirst];
+	const float Damping = Buffer.Damping[OldFirst];
+	const float DistanceCompliance = Buffer.DistanceCompliance[OldFirst];
+	const float BendCompliance = Buffer.BendCompliance[OldFirst];
+
+	Buffer.ClearRange(Range.Begin, Range.Capacity);
+	Range.Head = Range.Capacity - NumParticles;
+	Range.NumParticles = NumParticles;
+	Range.Revision = ++NextRevision;
+
+	const int32 First = Range.First();
+	for (int32 Index = 0; Index < NumParticles; ++Index)
+	{
+		const int32 Particle = First + Index;
+		const bool bPinned = (Index == 0 && bStartPinned) || (Index == NumParticles - 1 && bEndPinned);
+		Buffer.SetPosition(Particle, Positions[Index]);
+		Buffer.SetPrevPosition(Particle, Positions[Index]);
+		Buffer.SetVelocity(Particle, bPinned ? FVector3f::ZeroVector : Velocities[Index]);
+		Buffer.InvMass[Particle] = bPinned ? 0.0f : Range.InvMass;
+		Buffer.GravityScale[Particle] = GravityScale;
+		Buffer.Damping[Particle] = Damping;
+		Buffer.DistanceCompliance[Particle] = DistanceCompliance;
+		Buffer.BendCompliance[Particle] = BendCompliance;
+
+		if (Index < NumParticles - 1)
+		{
+			Buffer.DistanceRest[Particle] = RestLength;
+			Buffer.DistanceMask[Particle] = 1.0f;
+		}
+		if (Index < NumParticles - 2)
+		{
+			Buffer.BendRest[Particle] = 2.0f * RestLength;
+			Buffer.BendMask[Particle] = Range.bBending ? 1.0f : 0.0f;
+		}
+	}
+
+	// The segment count changed, candidate pairs are built again
+	const int32 SelfCollisionIndex = Algo::LowerBoundBy(SelfCollisions, Range.Begin, &FChainSelfCollision::Begin);
+	if (SelfCollisions.IsValidIndex(SelfCollisionIndex) && SelfCollisions[SelfCollisionIndex].ChainId == ChainId)
+	{
+		SelfCollisions[SelfCollisionIndex].Hash.Reset();
+		SelfCollisions[SelfCollisionIndex].Pairs.Reset();
+	}
+
+	UpdateTethers(Range);
+	return true;
+}
+
+void FChainXPBDSolver::ConfigureChain(int32 ChainId, const FChainSolverChainSettings& Settings)
+{
+	if (!Chains.IsValidIndex(ChainId)) return;
+
+	RecordCommand([ChainId, Settings](FChainXPBDSolver& Mirror) { Mirror.ConfigureChain(ChainId, Settings); });
+
+	FChainRange& Range = Chains[ChainId];
+	Range.InvMass = 1.0f / FMath::Max(Settings.ParticleMass, UE_KINDA_SMALL_NUMBER);
+	Range.bBending = Settings.bEnableBending;
+	Range.bTethers = Settings.bEnableTethers;
+	Range.TetherScale = 1.0f + FMath::Max(0.0f, Settings.TetherStretch);
+
+	for (int32 i = Range.First(); i < Range.Last() + 1; ++i)
+	{
+		// Keep pinned particles pinned
+		if (Buffer.InvMass[i] != 0.0f)
+		{
+			Buffer.InvMass[i] = Range.InvMass;
+		}
+		Buffer.GravityScale[i] = Settings.GravityScale;
+		Buffer.Damping[i] = FMath::Max(0.0f, Settings.Damping);
+		Buffer.DistanceCompliance[i] = FMath::Max(0.0f, Settings.DistanceCompliance);
+		Buffer.BendCompliance[i] = FMath::Max(0.0f, Settings.BendCompliance);
+		Buffer.BendMask[i] = (Settings.bEnableBending && i < Range.Last() - 1) ? 1.0f : 0.0f;
+	}
+
+	UpdateTethers(Range);
+
+	const int32 SelfCollisionIndex = Algo::LowerBoundBy(SelfCollisions, Range.Begin, &FChainSelfCollision::Begin);
+	const bool bHasSelfCollision = SelfCollisions.IsValidIndex(SelfCollisionIndex) && SelfCollisions[SelfCollisionIndex].ChainId == ChainId;
+	if (Settings.bEnableSelfCollision)
+	{
+		FChainSelfCollision& SelfCollision = bHasSelfCollision ? SelfCollisions[SelfCollisionIndex] : SelfCollisions.InsertDefaulted_GetRef(SelfCollisionIndex);
+		SelfCollision.ChainId = ChainId;
+		SelfCollision.Begin = Range.Begin;
+		SelfCollision.Radius = FMath::Max(Settings.CollisionRadius, UE_KINDA_SMALL_NUMBER);
+		SelfCollision.Hash.Reset();
+	}
+	else if (bHasSelfCollision)
+	{
+		SelfCollisions.RemoveAt(SelfCollisionIndex);
+	}
+}
+
+void FChainXPBDSolver::SetSegmentRestLength(int32 ChainId, float RestLength)
+{
+	if (!Chains.IsValidIndex(ChainId)) return;
+
+	RecordCommand([ChainId, RestLength](FChainXPBDSolver& Mirror) { Mirror.SetSegmentRestLength(ChainId, RestLength); });
+
+	const FChainRange& Range = Chains[ChainId];
+	for (int32 i = Range.First(); i < Range.Last(); ++i)
+	{
+		Buffer.DistanceRest[i] = RestLength;
+		Buffer.BendRest[i] = 2.0f * RestLength;
+	}
+
+	UpdateTethers(Range);
+}
+
+void FChainXPBDSolver::GetParticlePositions(int32 ChainId, TArray<FVector>& OutPositions) const
+{
+	OutPositions.Reset();
+	if (!Chains.IsValidIndex(ChainId)) return;
+
+	const FChainRange& Range = Chains[ChainId];
+	OutPositions.Reserve(Range.NumParticles);
+	for (int32 i = Range.First(); i <= Range.Last(); ++i)
+	{
+		OutPositions.Add(FVector(Buffer.GetPosition(i)));
+	}
+}
+
+float FChainXPBDSolver::GetMaxSpeedSquared(int32 ChainId) const
+{
+	if (!Chains.IsValidIndex(ChainId)) return 0.0f;
+
+	const FChainRange& Range = Chains[ChainId];
+	float MaxSpeedSq = 0.0f;
+	for (int32 i = Range.First(); i <= Range.Last(); ++i)
+	{
+		MaxSpeedSq = FMath::Max(MaxSpeedSq, FMath::Square(Buffer.VelX[i]) + FMath::Square(Buffer.VelY[i]) + FMath::Square(Buffer.VelZ[i]));
+	}
+	return MaxSpeedSq;
+}
+
+void FChainXPBDSolver::AddVelocity(int32 ChainId, const FVector& Location, float Radius, const FVector& DeltaVelocity)
+{
+	if (!Chains.IsValidIndex(ChainId)) return;
+
+	RecordCommand([ChainId, Location, Radius, DeltaVelocity](FChainXPBDSolver& Mirror) { Mirror.AddVelocity(ChainId, Location, Radius, DeltaVelocity); });
+
+	const FChainRange& Range = Chains[ChainId];
+	const FVector3f Center(Location);
+	const FVector3f Delta(DeltaVelocity);
+	const float RadiusSq = FMath::Square(Radius);
+
+	for (int32 i = Range.First(); i <= Range.Last(); ++i)
+	{
+		if (Buffer.InvMass[i] == 0.0f || FVector3f::DistSquared(Buffer.GetPosition(i), Center) > RadiusSq) continue;
+
+		Buffer.SetVelocity(i, FVector3f(Buffer.VelX[i], Buffer.VelY[i], Buffer.VelZ[i]) + Delta);
+	}
+}
+
+void FChainXPBDSolver::GetParticleState(int32 ChainId, TArray<FVector3f>& OutPositions, TArray<FVector3f>& OutVelocities) const
+{
+	OutPositions.Reset();
+	OutVelocities.Reset();
+	if (!Chains.IsValidIndex(ChainId)) return;
+
+	const FChainRange& Range = Chains[ChainId];
+	OutPositions.Reserve(Range.NumParticles);
+	OutVelocities.Reserve(Range.NumParticles);
+	for (int32 i = Range.First(); i <= Range.Last(); ++i)
+	{
+		OutPositions.Add(Buffer.GetPosition(i));
+		OutVelocities.Add(FVector3f(Buffer.VelX[i], Buffer.VelY[i], Buffer.VelZ[i]));
+	}
+}
+
+void FChainXPBDSolver::SetParticleState(int32 ChainId, TConstArrayView<FVector3f> Positions, TConstArrayView<FVector3f> Velocities)
+{
+	if (!Chains.IsValidIndex(ChainId)) return;
+
+	const FChainRange& Range = Chains[ChainId];
+	if (Positions.Num() != Range.NumParticles || Velocities.Num() != Range.NumParticles) return;
+
+	for (int32 Index = 0; Index < Range.NumParticles; ++Index)
+	{
+		const int32 Particle = Range.First() + Index;
+		Buffer.SetPosition(Particle, Positions[Index]);
+		Buffer.SetPrevPosition(Particle, Positions[Index]);
+		Buffer.SetVelocity(Particle, Velocities[Index]);
+	}
+}
+
+void FChainXPBDSolver::SetFirstSegmentRestLength(int32 ChainId, float RestLength)
+{
+	if (!Chains.IsValidIndex(ChainId)) return;
+
+	RecordCommand([ChainId, RestLength](FChainXPBDSolver& Mirror) { Mirror.SetFirstSegmentRestLength(ChainId, RestLength); });
+
+	const FChainRange& Range = Chains[ChainId];
+	const int32 First = Range.First();
+	Buffer.DistanceRest[First] = RestLength;
+	Buffer.BendRest[First] = RestLength + Buffer.DistanceRest[First + 1];
+
+	UpdateTethers(Range);
+}
+
+bool FChainXPBDSolver::InsertParticleAtStart(int32 ChainId, float FirstRestLength, float SecondRestLength)
+{
+	if (!Chains.IsValidIndex(ChainId)) return false;
+
+	FChainRange& Range = Chains[ChainId];
+	if (Range.Head == 0) return false;
+
+	RecordCommand([ChainId, FirstRestLength, SecondRestLength](FChainXPBDSolver& Mirror) { Mirror.InsertParticleAtStart(ChainId, FirstRestLength, SecondRestLength); });
+
+	// The start particle moves one slot down; its old slot becomes the inserted particle.
+	const int32 Inserted = Range.First();
+	const int32 Start = Inserted - 1;
+	const int32 Next = Inserted + 1;
+	CopyParticle(Inserted, Start);
+
+	const float Alpha = FirstRestLength / FMath::Max(FirstRestLength + SecondRestLength, UE_KINDA_SMALL_NUMBER);
+	Buffer.SetPosition(Inserted, FMath::Lerp(Buffer.GetPosition(Start), Buffer.GetPosition(Next), Alpha));
+	Buffer.SetPrevPosition(Inserted, FMath::Lerp(FVector3f(Buffer.PrevX[Start], Buffer.PrevY[Start], Buffer.PrevZ[Start]), FVector3f(Buffer.PrevX[Next], Buffer.PrevY[Next], Buffer.PrevZ[Next]), Alpha));
+	Buffer.SetVelocity(Inserted, FMath::Lerp(FVector3f(Buffer.VelX[Start], Buffer.VelY[Start], Buffer.VelZ[Start]), FVector3f(Buffer.VelX[Next], Buffer.VelY[Next], Buffer.VelZ[Next]), Alpha));
+	Buffer.InvMass[Inserted] = Range.InvMass;
+
+	// Start -> Inserted is the new first segment, Inserted -> Next keeps the old constraint slot
+	Buffer.DistanceRest[Start] = FirstRestLength;
+	Buffer.DistanceCompliance[Start] = Buffer.DistanceCompliance[Inserted];
+	Buffer.DistanceMask[Start] = 1.0f;
+	Buffer.DistanceRest[Inserted] = SecondRestLength;
+
+	Buffer.BendRest[Start] = FirstRestLength + SecondRestLength;
+	Buffer.BendCompliance[Start] = Buffer.BendCompliance[Inserted];
+	Buffer.BendMask[Start] = Range.bBending ? 1.0f : 0.0f;
+	Buffer.BendRest[Inserted] = SecondRestLength + Buffer.DistanceRest[Next];
+
+	--Range.Head;
+	++Range.NumParticles;
+	Range.Revision = ++NextRevision;
+	UpdateTethers(Range);
+	return true;
+}
+
+bool FChainXPBDSolver::RemoveParticleAtStart(int32 ChainId, float FirstRestLength)
+{
+	if (!Chains.IsValidIndex(ChainId)) return false;
+
+	FChainRange& Range = Chains[ChainId];
+	if (Range.NumParticles <= 3) return false;
+
+	RecordCommand([ChainId, FirstRestLength](FChainXPBDSolver& Mirror) { Mirror.RemoveParticleAtStart(ChainId, FirstRestLength); });
+
+	// The start particle moves one slot up, over the removed particle.
+	const int32 Start = Range.First();
+	const int32 Removed = Start + 1;
+	CopyParticle(Start, Removed);
+
+	Buffer.DistanceRest[Removed] = FirstRestLength;
+	Buffer.BendRest[Removed] = FirstRestLength + Buffer.DistanceRest[Removed + 1];
+
+	Buffer.ClearRange(Start, 1);
+
+	++Range.Head;
+	--Range.NumParticles;
+	Range.Revision = ++NextRevision;
+	UpdateTethers(Range);
+	return true;
+}
+
+void FChainXPBDSolver::SetIterations(int32 InIterations)
+{
+	RecordCommand([InIterations](FChainXPBDSolver& Mirror) { Mirror.SetIterations(InIterations); });
+
+	Iterations = FMath::Max(1, InIterations);
+}
+
+void FChainXPBDSolver::SetParticlePinned(int32 ChainId, int32 Index, bool bPinned)
+{
+	if (!Chains.IsValidIndex(ChainId)) return;
+
+	const FChainRange& Range = Chains[ChainId];
+	if (Index < 0 || Index >= Range.NumParticles) return;
+
+	RecordCommand([ChainId, Index, bPinned](FChainXPBDSolver& Mirror) { Mirror.SetParticlePinned(ChainId, Index, bPinned); });
+
+	const int32 Particle = Range.First() + Index;
+	Buffer.InvMass[Particle] = bPinned ? 0.0f : Range.InvMass;
+	Buffer.SetVelocity(Particle, FVector3f::ZeroVector);
+
+	UpdateTethers(Range);
+}
+
+void FChainXPBDSolver::SetKinematicTarget(int32 ChainId, int32 Index, const FVector& Location, const FVector& Velocity)
+{
+	if (!Chains.IsValidIndex(ChainId)) return;
+
+	const FChainRange& Range = Chains[ChainId];
+	if (Index < 0 || Index >= Range.NumParticles) return;
+
+	const int32 Particle = Range.First() + Index;
+	if (Buffer.InvMass[Particle] != 0.0f) return;
+
+	RecordCommand([ChainId, Index, Location, Velocity](FChainXPBDSolver& Mirror) { Mirror.SetKinematicTarget(ChainId, Index, Location, Velocity); });
+
+	Buffer.SetPosition(Particle, FVector3f(Location));
+	Buffer.SetVelocity(Particle, FVector3f(Velocity));
+}
+
+void FChainXPBDSolver::SetSegmentContacts(int32 ChainId, TConstArrayView<FChainSegmentContact> Contacts, float Friction)
+{
+	if (!Chains.IsValidIndex(ChainId)) return;
+
+	RecordCommand([ChainId, Contacts = TArray<FChainSegmentContact>(Contacts.GetData(), Contacts.Num()), Friction](FChainXPBDSolver& Mirror)
+	{
+		Mirror.SetSegmentContacts(ChainId, Contacts, Friction);
+	});
+
+	const FChainRange& Range = Chains[ChainId];
+	FMemory::Memzero(Buffer.ContactMask.GetData() + Range.Begin, Range.Capacity * sizeof(float));
+
+	for (const FChainSegmentContact& Contact : Contacts)
+	{
+		if (Contact.Segment < 0 || Contact.Segment >= Range.NumParticles - 1) continue;
+
+		const int32 Index = Range.First() + Contact.Segment;
+		Buffer.ContactNX[Index] = Contact.Normal.X;
+		Buffer.ContactNY[Index] = Contact.Normal.Y;
+		Buffer.ContactNZ[Index] = Contact.Normal.Z;
+		Buffer.ContactOffset[Index] = Contact.Offset;
+		Buffer.ContactParam[Index] = FMath::Clamp(Contact.Param, 0.0f, 1.0f);
+		Buffer.ContactFriction[Index] = FMath::Max(0.0f, Friction);
+		Buffer.ContactMask[Index] = 1.0f;
+	}
+}
+
+void FChainXPBDSolver::Step(float DeltaTime, const FVector& Gravity)
+{
+	StepRange(0, Buffer.Num(), DeltaTime, Gravity, Iterations);
+}
+
+void FChainXPBDSolver::StepRange(int32 Begin, int32 End, float DeltaTime, const FVector& Gravity, int32 NumIterations)
+{
+	if (Begin >= End)
+	{
+		return;
+	}
+
+	const FChainParticleSpan Span = { Begin, End };
+	StepRanges(MakeArrayView(&Span, 1), TConstArrayView<FChainSegmentPair>(), DeltaTime, Gravity, NumIterations);
+}
+
+void FChainXPBDSolver::StepRanges(TConstArrayView<FChainParticleSpan> Spans, TConstArrayView<FChainSegmentPair> CrossPairs, float DeltaTime, const FVector& Gravity, int32 NumIterations)
+{
+	if (Spans.Num() == 0 || DeltaTime <= UE_SMALL_NUMBER)
+	{
+		return;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChainXPBDSolver::StepRange);
+
+	const float InvDeltaTimeSq = 1.0f / (DeltaTime * DeltaTime);
+
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(ChainSolver::Integrate);
+		for (const FChainParticleSpan& Span : Spans)
+		{
+			check(Span.Begin % ChainParticleBlockSize == 0 && Span.End % ChainParticleBlockSize == 0 && Span.End <= Buffer.Num());
+			ChainSolverKernels::Integrate(Buffer, Span.Begin, Span.End, FVector3f(Gravity), DeltaTime);
+			ChainSolverKernels::ResetLambdas(Buffer, Span.Begin, Span.End);
+		}
+	}
+
+	// Self colliding chains of each span, pairs follow the predicted positions of this step
+	TArray<FIntPoint, TInlineAllocator<8>> SelfCollisionRanges;
+	for (const FChainParticleSpan& Span : Spans)
+	{
+		const int32 FirstSelfCollision = Algo::LowerBoundBy(SelfCollisions, Span.Begin, &FChainSelfCollision::Begin);
+		int32 EndSelfCollision = FirstSelfCollision;
+		while (EndSelfCollision < SelfCollisions.Num() && SelfCollisions[EndSelfCollision].Begin < Span.End)
+		{
+			++EndSelfCollision;
+		}
+		SelfCollisionRanges.Add(FIntPoint(FirstSelfCollision, EndSelfCollision));
+	}
+
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(ChainSolver::SelfCollisionBroadphase);
+		for (const FIntPoint& SelfCollisionRange : SelfCollisionRanges)
+		{
+			for (int32 Index = SelfCollisionRange.X; Index < SelfCollisionRange.Y; ++Index)
+			{
+				UpdateSelfCollision(SelfCollisions[Index]);
+			}
+		}
+	}
+
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(ChainSolver::SolveConstraints);
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			for (int32 SpanIndex = 0; SpanIndex < Spans.Num(); ++SpanIndex)
+			{
+				const FChainParticleSpan& Span = Spans[SpanIndex];
+				ChainSolverKernels::SolveDistanceConstraints(Buffer, Span.Begin, Span.End, InvDeltaTimeSq);
+				ChainSolverKernels::SolveBendConstraints(Buffer, Span.Begin, Span.End, InvDeltaTimeSq);
+				ChainSolverKernels::SolveTethers(Buffer, Span.Begin, Span.End);
+				for (int32 Index = SelfCollisionRanges[SpanIndex].X; Index < SelfCollisionRanges[SpanIndex].Y; ++Index)
+				{
+					ChainSolverKernels::SolveSegmentPairs(Buffer, SelfCollisions[Index].Pairs);
+				}
+			}
+
+			ChainSolverKernels::SolveSegmentPairs(Buffer, CrossPairs);
+
+			for (const FChainParticleSpan& Span : Spans)
+			{
+				ChainSolverKernels::SolveContacts(Buffer, Span.Begin, Span.End);
+			}
+		}
+	}
+
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(ChainSolver::UpdateVelocities);
+		for (const FChainParticleSpan& Span : Spans)
+		{
+			ChainSolverKernels::UpdateVelocities(Buffer, Span.Begin, Span.End, 1.0f / DeltaTime);
+		}
+	}
+}
+
+void FChainXPBDSolver::UpdateTethers(const FChainRange& Range)
+{
+	// Head room and block padding lanes are gathered by the SIMD tether solve too,
+	// every lane of the range points inside it so islands never read each other
+	for (int32 i = Range.Begin; i < Range.Begin + Range.Capacity; ++i)
+	{
+		Buffer.TetherRest[i] = 0.0f;
+		Buffer.TetherAnchor[i] = Range.Begin;
+	}
+
+	const int32 First = Range.First();
+	const int32 Last = Range.Last();
+
+	if (!Range.bTethers) return;
+
+	// Forward pass: closest pin before each particle, measured along the chain
+	int32 Anchor = INDEX_NONE;
+	float Distance = 0.0f;
+	for (int32 i = First; i <= Last; ++i)
+	{
+		if (Buffer.InvMass[i] == 0.0f)
+		{
+			Anchor = i;
+			Distance = 0.0f;
+			continue;
+		}
+		if (Anchor == INDEX_NONE) continue;
+
+		Distance += Buffer.DistanceRest[i - 1];
+		Buffer.TetherRest[i] = Distance * Range.TetherScale;
+		Buffer.TetherAnchor[i] = Anchor;
+	}
+
+	// Backward pass: keep the pin after the particle when it is closer
+	Anchor = INDEX_NONE;
+	Distance = 0.0f;
+	for (int32 i = Last; i >= First; --i)
+	{
+		if (Buffer.InvMass[i] == 0.0f)
+		{
+			Anchor = i;
+			Distance = 0.0f;
+			continue;
+		}
+		if (Anchor == INDEX_NONE) continue;
+
+		Distance += Buffer.DistanceRest[i];
+		const float Rest = Distance * Range.TetherScale;
+		if (Buffer.TetherRest[i] == 0.0f || Rest < Buffer.TetherRest[i])
+		{
+			Buffer.TetherRest[i] = Rest;
+			Buffer.TetherAnchor[i] = Anchor;
+		}
+	}
+}
+
+void FChainXPBDSolver::UpdateSelfCollision(FChainSelfCollision& SelfCollision)
+{
+	const FChainRange& Range = Chains[SelfCollision.ChainId];
+	const int32 First = Range.First();
+	const int32 NumSegments = Range.NumParticles - 1;
+
+	float MinLength = UE_BIG_NUMBER;
+	float MaxLength = 0.0f;
+	SelfCollision.Middles.SetNumUninitialized(NumSegments);
+	for (int32 Segment = 0; Segment < NumSegments; ++Segment)
+	{
+		SelfCollision.Middles[Segment] = (Buffer.GetPosition(First + Segment) + Buffer.GetPosition(First + Segment + 1)) * 0.5f;
+		MinLength = FMath::Min(MinLength, Buffer.DistanceRest[First + Segment]);
+		MaxLength = FMath::Max(MaxLength, Buffer.DistanceRest[First + Segment]);
+	}
+
+	// Two capsules overlap only if their middles are closer than a segment length plus a diameter
+	const float Diameter = 2.0f * SelfCollision.Radius;
+	if (!SelfCollision.Hash.Build(SelfCollision.Middles, MaxLength + Diameter))
+	{
+		return;
+	}
+
+	// Neighbours closer than a diameter along the chain always touch, they are held by the distance constraints
+	const int32 NumExcluded = FMath::Max(1, FMath::CeilToInt(Diameter / FMath::Max(MinLength, UE_KINDA_SMALL_NUMBER)));
+
+	SelfCollision.Pairs.Reset();
+	for (int32 Segment = 0; Segment < NumSegments; ++Segment)
+	{
+		SelfCollision.Hash.ForEachNeighbour(SelfCollision.Middles[Segment], [&SelfCollision, First, Segment, NumExcluded, Diameter](int32 Other)
+		{
+			if (Other > Segment + NumExcluded)
+			{
+				SelfCollision.Pairs.Add({ First + Segment, First + Other, Diameter });
+			}
+		});
+	}
+}
+
+void FChainXPBDSolver::CopyParticle(int32 From, int32 To)
+{
+	Buffer.SetPosition(To, Buffer.GetPosition(From));
+	Buffer.SetPrevPosition(To, FVector3f(Buffer.PrevX[From], Buffer.PrevY[From], Buffer.PrevZ[From]));
+	Buffer.SetVelocity(To, FVector3f(Buffer.VelX[From], Buffer.VelY[From], Buffer.VelZ[From]));
+	Buffer.InvMass[To] = Buffer.InvMass[From];
+	Buffer.GravityScale[To] = Buffer.GravityScale[From];
+	Buffer.Damping[To] = Buffer.Damping[From];
+}
+
+int32 FChainXPBDSolver::AllocateRange(int32 Capacity)
+{
+	for (int32 FreeIndex = 0; FreeIndex < FreeRanges.Num(); ++FreeIndex)
+	{
+		FChainRange& Free = FreeRanges[FreeIndex];
+		if (Free.Capacity < Capacity)
+		{
+			continue;
+		}
+
+		const int32 Begin = Free.Begin;
+		Free.Begin += Capacity;
+		Free.Capacity -= Capacity;
+		if (Free.Capacity == 0)
+		{
+			FreeRanges.RemoveAt(FreeIndex);
+		}
+		return Begin;
+	}
+
+	return Buffer.AddParticles(Capacity);
+}
+
+void FChainXPBDSolver::ReleaseRange(int32 Begin, int32 Capacity)
+{
+	Buffer.ClearRange(Begin, Capacity);
+
+	// Merge with the free ranges right before and right after, so churn does not fragment the buffer
+	const int32 Index = Algo::LowerBoundBy(FreeRanges, Begin, &FChainRange::Begin);
+	FChainRange* Merged = nullptr;
+	if (Index > 0 && FreeRanges[Index - 1].Begin + FreeRanges[Index - 1].Capacity == Begin)
+	{
+		Merged = &FreeRanges[Index - 1];
+		Merged->Capacity += Capacity;
+	}
+	else
+	{
+		FChainRange Free;
+		Free.Begin = Begin;
+		Free.Capacity = Capacity;
+		Merged = &FreeRanges.Insert_GetRef(Free, Index);
+	}
+
+	const int32 MergedIndex = static_cast<int32>(Merged - FreeRanges.GetData());
+	if (FreeRanges.IsValidIndex(MergedIndex + 1) && Merged->Begin + Merged->Capacity == FreeRanges[MergedIndex + 1].Begin)
+	{
+		Merged->Capacity += FreeRanges[MergedIndex + 1].Capacity;
+		FreeRanges.RemoveAt(MergedIndex + 1);
+	}
+
+	// Nothing lives past a free range at the end: give it back instead of stepping it as padding
+	const FChainRange& Last = FreeRanges.Last();
+	if (Last.Begin + Last.Capacity == Buffer.Num())
+	{
+		Buffer.Truncate(Last.Begin);
+		FreeRanges.Pop();
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SceneComponent.h"
+#include "UObject/ObjectKey.h"
+
+/**
+ * Anchor locations shared by every chain of a world. A component / socket is evaluated at most once per frame,
+ * however many chain ends follow it (four shackles on one prisoner, both ends of a chain on one mesh).
+ * Components are tracked through their TransformUpdated event and only evaluated again once they moved;
+ * sockets of skinned meshes follow bones that move without it, and are evaluated every frame they are used.
+ * Each location comes with the velocity of the anchor over the last frame, for kinematic targets.
+ */
+class CHAINCONSTRAINT_API FChainAnchorTracker
+{
+public:
+
+	FChainAnchorTracker() = default;
+	~FChainAnchorTracker();
+
+	FChainAnchorTracker(const FChainAnchorTracker&) = delete;
+	FChainAnchorTracker& operator=(const FChainAnchorTracker&) = delete;
+
+	/** Starts a frame of DeltaTime seconds and stops tracking the components no anchor used for a while. */
+	void BeginFrame(float InDeltaTime);
+
+	/** World location of a component or one of its sockets. OutVelocity, if set, receives its velocity over the last frame. */
+	FVector Resolve(USceneComponent* Component, FName SocketName, FVector* OutVelocity = nullptr);
+
+	/** Stops tracking every component. */
+	void Reset();
+
+	int32 GetNumTrackedComponents() const { return Components.Num(); }
+
+private:
+
+	struct FTrackedSocket
+	{
+		FName SocketName = NAME_None;
+		FVector Location = FVector::ZeroVector;
+		FVector Velocity = FVector::ZeroVector;
+
+		/** Frame Location was last resolved for. */
+		uint64 Frame = 0;
+	};
+
+	struct FTrackedComponent
+	{
+		TWeakObjectPtr<USceneComponent> Component;
+		FDelegateHandle TransformUpdatedHandle;
+
+		/** Last frames the component moved, teleported and was used by an anchor. */
+		uint64 MovedFrame = 0;
+		uint64 TeleportFrame = 0;
+		uint64 UsedFrame = 0;
+
+		/** Sockets of skinned meshes move with their bones, without any transform update of the component. */
+		bool bSkinned = false;
+
+		TArray<FTrackedSocket, TInlineAllocator<2>> Sockets;
+	};
+
+	void OnTransformUpdated(USceneComponent* Component, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+	void Untrack(FTrackedComponent& Tracked);
+
+	TMap<TObjectKey<USceneComponent>, FTrackedComponent> Components;
+
+	float DeltaTime = 0.0f;
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/NetSerialization.h"
+#include "ChainFullRepState.generated.h"
+
+/**
+ * Replicated pose of a chain in FullRep mode: every pose point (particle or link) of the server chain.
+ *
+ * Serialized by hand with NetDeltaSerialize:
+ * - points are quantized relative to the root, on PositionBits per axis over [-Range, Range]
+ * - rotations (rigid links only) are packed as smallest-three quaternions on 2 + 3 x RotationBits bits
+ * - each update is delta compressed against the state the connection last received: unchanged points cost one bit,
+ *   moved points send their quantized difference
+ * - nothing is sent while the quantized pose does not change
+ */
+USTRUCT()
+struct CHAINCONSTRAINT_API FChainFullRepState
+{
+	GENERATED_BODY()
+
+	/**
+	 * Server pose, written by the owning actor before replication: every pose point relative to Root (the first
+	 * offset is zero), and one rotation per point for rigid links. Rotations are empty for particle chains.
+	 */
+	FVector Root = FVector::ZeroVector;
+	TArray<FVector> Offsets;
+	TArray<FQuat> Rotations;
+	float Length = 0.0f;
+
+	/** Quantization, set by the server from the profile and sent with every full update. */
+	int32 PositionBits = 16;
+	int32 RotationBits = 10;
+	float Range = 1000.0f;
+
+	/** Incremented on clients each time a state is received. */
+	int32 ReceivedRevision = 0;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms);
+
+private:
+
+	/** Quantized pose of the last received state, base of the next delta on clients. */
+	TArray<FIntVector> QuantizedPositions;
+	TArray<uint32> PackedRotations;
+};
+
+template<>
+struct TStructOpsTypeTraits<FChainFullRepState> : public TStructOpsTypeTraitsBase2<FChainFullRepState>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
@@ -2,17 +2,29 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "UObject/ObjectKey.h"
 #include "ChainProfile.h"
+#include "ChainXPBDSolver.h"
+#include "ChainTubeMesh.h"
+#include "ChainFullRepState.h"
 #include "ChainInstanceActor.generated.h"
 
 class UStaticMeshComponent;
 class UPhysicsConstraintComponent;
+class UProceduralMeshComponent;
+class UChainSimulationSubsystem;
+struct FChainWorldCollision;
+
+/** Chain finished building. */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FChainReadySignature, AChainInstanceActor*, Chain);
+/** Segment LinkIndex of a particle chain started touching OtherComponent. Requires Physics.bNotifyRigidBodyCollision. */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_FiveParams(FChainHitSignature, AChainInstanceActor*, Chain, UPrimitiveComponent*, OtherComponent, FVector, Location, FVector, Normal, int32, LinkIndex);
 
 /**
  * Chain anchor definition: can be a world location or a component/socket.
  */
 USTRUCT(BlueprintType)
-struct FChainAnchor
+struct CHAINCONSTRAINT_API FChainAnchor
 {
 	GENERATED_BODY()
 
@@ -45,6 +57,27 @@ struct FChainAnchor
 	}
 };
 
+/**
+ * Replicated pose of a chain in KeyLinksRep mode: the root position, then evenly spaced key points
+ * (the last one being the end of the chain) relative to the root. Clients pin their own chain to these
+ * keys and simulate the links in between locally, whatever their own segment count.
+ */
+USTRUCT()
+struct FChainKeyLinkState
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FVector_NetQuantize Root = FVector::ZeroVector;
+
+	UPROPERTY()
+	TArray<FVector_NetQuantize10> KeyOffsets;
+
+	/** Current chain length, for chains reeling in or out. */
+	UPROPERTY()
+	float Length = 0.0f;
+};
+
 /**
  * AChainInstanceActor:
  * - Consumes UChainProfile
@@ -53,7 +86,7 @@ struct FChainAnchor
  * - Server-authoritative physics
  */
 UCLASS()
-class YOURMODULE_API AChainInstanceActor : public AActor
+class CHAINCONSTRAINT_API AChainInstanceActor : public AActor
 {
 	GENERATED_BODY()
 
@@ -61,7 +94,7 @@ public:
 	AChainInstanceActor();
 
 	/** Data Asset describing the chain (mesh, physics, constraints, LOD, network). */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chain")
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, ReplicatedUsing = OnRep_Profile, Category = "Chain")
 	TObjectPtr<UChainProfile> Profile;
 
 	/** Start / End anchors (socket, component, or world location). */
@@ -75,10 +108,45 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chain")
 	bool bAutoRebuild = false;
 
+	/**
+	 * If true, game world builds create links and constraints over several frames, within Chain.Build.BudgetMs,
+	 * showing a tube proxy of the initial pose meanwhile. OnChainReady fires once the chain is complete.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chain")
+	bool bAsyncBuild = false;
+
 	/** Current effective segment count (after LOD). */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Chain")
 	int32 CurrentSegmentCount;
 
+	/** Current LOD level (index into Profile->LODLevels), INDEX_NONE until the first evaluation. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Chain|LOD")
+	int32 CurrentLODIndex = INDEX_NONE;
+
+	/** Current chain length, moves towards TargetLength at the profile reel speed. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Chain|Dynamics")
+	float CurrentLength = 0.0f;
+
+	/** Length requested by SetTargetLength. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Chain|Dynamics")
+	float TargetLength = 0.0f;
+
+	/** Particle chains only: a link starts touching the world. Rigid links report through their own OnComponentHit. */
+	UPROPERTY(BlueprintAssignable, Category = "Chain|Collision")
+	FChainHitSignature OnChainHit;
+
+	/** The chain finished building, immediately or after a time-sliced build. */
+	UPROPERTY(BlueprintAssignable, Category = "Chain")
+	FChainReadySignature OnChainReady;
+
+	/** Server pose replicated to clients when the profile uses KeyLinksRep. */
+	UPROPERTY(ReplicatedUsing = OnRep_KeyLinkState)
+	FChainKeyLinkState KeyLinkState;
+
+	/** Server pose replicated to clients when the profile uses FullRep (quantized, delta compressed). */
+	UPROPERTY(ReplicatedUsing = OnRep_FullRepState)
+	FChainFullRepState FullRepState;
+
 	/** Dynamic arrays holding mesh links and constraints. */
 	UPROPERTY(VisibleAnywhere, Category = "Chain|Runtime")
 	TArray<TObjectPtr<UStaticMeshComponent>> LinkComponents;
@@ -86,34 +154,276 @@ public:
 	UPROPERTY(VisibleAnywhere, Category = "Chain|Runtime")
 	TArray<TObjectPtr<UPhysicsConstraintComponent>> ConstraintComponents;
 
+	/** Procedural tube drawn through the particles, when the profile renders the chain as a tube. */
+	UPROPERTY(VisibleAnywhere, Category = "Chain|Runtime")
+	TObjectPtr<UProceduralMeshComponent> TubeMesh;
+
+	/** Stand-in drawn while a time-sliced build is pending. */
+	UPROPERTY(Transient)
+	TObjectPtr<UProceduralMeshComponent> BuildProxy;
+
+	/** Registered but inactive components kept for reuse by RebuildChain and segment count changes. */
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UStaticMeshComponent>> LinkPool;
+
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UPhysicsConstraintComponent>> ConstraintPool;
+
+	/** True if the current profile drives the links with the particle (XPBD) solver instead of Chaos bodies. */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Chain")
+	bool UsesParticleSolver() const;
+
+	/** True if the links are drawn by the subsystem's instanced components (no link components). */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Chain")
+	bool UsesInstancedLinks() const;
+
+	/** True if the chain is drawn as one procedural tube (no link components). */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Chain")
+	bool UsesTubeMesh() const;
+
+	/** True if every link is drawn by its own static mesh component. */
+	bool UsesLinkComponents() const { return !UsesInstancedLinks() && !UsesTubeMesh(); }
+
+	/** True once links have been generated, and no time-sliced build is pending. */
+	bool HasBuiltChain() const { return !bBuildPending && (LinkComponents.Num() > 0 || ParticleChainId != INDEX_NONE); }
+
+	/** True while a time-sliced build is waiting for frame time. */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Chain")
+	bool IsBuildPending() const { return bBuildPending; }
+
+	/** Number of links currently built, drawn by components, instances or the tube. */
+	int32 GetNumLinks() const { return FMath::Max(LinkComponents.Num(), LinkTransforms.Num()); }
+
+	/** Location used to measure the distance to the viewers for LOD selection. */
+	FVector GetLODReferenceLocation() const;
+
 protected:
 
+	friend class UChainSimulationSubsystem;
+
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void OnConstruction(const FTransform& Transform) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	UFUNCTION()
+	void OnRep_Profile();
+
+	UFUNCTION()
+	void OnRep_KeyLinkState();
+
+	UFUNCTION()
+	void OnRep_FullRepState();
+
+	/** True on clients pinning their chain to the replicated server pose (KeyLinksRep or FullRep). */
+	bool IsReplicatedPoseClient() const;
+
+	/** Handles freshly received key positions and length: a new key layout snaps, later updates are blended. */
+	void OnReceivedKeyPositions(float ReplicatedLength);
+
+	/**
+	 * Per-frame network work, called by the subsystem before the solve:
+	 * the server captures its key links, clients blend their key targets towards the replicated ones.
+	 */
+	void UpdateReplication(float DeltaTime);
+
+	/** Samples the current pose into KeyLinkState, only when a key moved past the profile tolerance. */
+	void CaptureKeyLinkState();
+
+	/** Copies the whole current pose into FullRepState; unchanged quantized poses are not resent. */
+	void CaptureFullRepState();
+
+	/** Pins the key points of the client chain (particles or rigid links), re-pinning when the point count changes. */
+	void PinKeyPoints();
 
 	/** Build chain using the assigned profile. */
 	UFUNCTION(BlueprintCallable, Category = "Chain")
 	void InitializeFromProfile();
 
-	/** Destroy previous chain and rebuild a new one. */
+	/** Rebuild the chain from the profile, reusing existing and pooled components. */
 	UFUNCTION(BlueprintCallable, Category = "Chain")
 	void RebuildChain();
 
-	/** Core generation function: creates links + constraints. */
-	void BuildChain();
+	/** Starts a build: segment count and length from the profile, no component configured yet. */
+	void BeginBuild();
+
+	/**
+	 * Core generation function: brings links + constraints to the current segment count, one component at a time.
+	 * Returns false if Deadline (FPlatformTime::Seconds) passed first; the next call resumes where this one stopped.
+	 */
+	bool ContinueBuild(double Deadline);
+
+	/** Registers the particles, binds the anchors and applies the LOD state. OnChainReady is fired by the caller. */
+	void FinishBuild();
+
+	/** True if RebuildChain should hand the build to the subsystem's time-sliced queue. */
+	bool ShouldBuildAsync() const;
+
+	/** Creates, updates or destroys the build proxy to match bBuildPending. */
+	void UpdateBuildProxy();
+
+	/** Grows or shrinks LinkComponents, taking or returning only the delta from the pool. */
+	void ResizeLinkComponents(int32 NumLinks);
 
-	/** Apply profile settings (mesh, mass, collision, damping…). */
+	/** Grows or shrinks ConstraintComponents, new joints are bound to their links. */
+	void ResizeConstraintComponents(int32 NumConstraints);
+
+	/** Takes a configured link from the pool, creating one if the pool is empty. */
+	UStaticMeshComponent* AcquireLinkComponent();
+
+	/** Deactivates a link and returns it to the pool. */
+	void ReleaseLinkComponent(UStaticMeshComponent* Link);
+
+	/** Takes a configured joint from the pool, creating one if the pool is empty. */
+	UPhysicsConstraintComponent* AcquireConstraintComponent();
+
+	/** Terminates a joint and returns it to the pool. */
+	void ReleaseConstraintComponent(UPhysicsConstraintComponent* Constraint);
+
+	/** Creates or destroys the tube component to match the profile render mode. */
+	void SetupTubeMesh();
+
+	/** Rebuilds the tube vertices from the particles; the section is only re-created when its topology changes. */
+	void UpdateTubeMesh();
+
+	/** Binds joint Index to links Index and Index + 1. */
+	void BindConstraint(int32 Index);
+
+	/** Apply profile settings (mesh, mass, collision, damping…) from the profile's compiled template. */
 	void ApplyProfileToLink(UStaticMeshComponent* Link);
 
-	/** Apply profile constraint settings to a joint. */
+	/** Applies the compiled template's collision to a live link: the profile's, or ignoring everything. */
+	void ApplyLinkCollision(UStaticMeshComponent* Link, bool bEnableCollision);
+
+	/** Applies simulation, collision and rate settings of the current LOD level. */
+	void ApplyLODSimulationState();
+
+	/** Current chain pose as a polyline: particles for the XPBD backend, link locations otherwise. */
+	void GetChainPose(TArray<FVector>& OutPose) const;
+
+	/** Apply profile constraint settings to a joint, from the profile's compiled template. */
 	void ApplyProfileToConstraint(UPhysicsConstraintComponent* Constraint);
 
 	/** Anchor link 0 to StartAnchor, link N to EndAnchor (if any). */
 	void BindAnchors();
 
-	/** Removes existing links and constraints. */
+	/** Destroys existing links and constraints, including pooled ones. */
 	void ClearChain();
 
+	/** Lays out the particles between the anchors and registers the chain with the simulation subsystem. */
+	void InitializeParticleSolver();
+
+	/** Pose a new chain starts from: baked rest pose between two anchors (returns true), straight line otherwise. */
+	bool MakeInitialPose(TArray<FVector>& OutPositions) const;
+
+	/** Adds the chain to the simulation subsystem with the given particle positions. */
+	void RegisterParticleChain(TConstArrayView<FVector> Positions);
+
+	/** Removes the chain from the simulation subsystem. */
+	void ReleaseParticleChain();
+
+	/** Re-samples the particle chain onto a new segment count in place, keeping its velocities, pins and stepping. */
+	void ResizeParticleChain(int32 NewSegmentCount);
+
+	/** Moves pinned particles to their anchors. Called by the subsystem before the solve. */
+	void PushAnchorTargets();
+
+	/**
+	 * Moves CurrentLength towards TargetLength. Only the first segment (at the start anchor) changes length;
+	 * a particle and a link are inserted or removed there when it leaves [0.5, 1.5] x the nominal segment length.
+	 * At most one insertion or removal per frame. Called by the subsystem before the solve.
+	 */
+	void UpdateReel(float DeltaTime);
+
+	/**
+	 * Sleep bookkeeping before the solve: a sleeping chain checks its wake conditions (anchor motion, and overlaps
+	 * when bCheckOverlap), an awake one measures its anchor speed and, for rigid links, counts still frames.
+	 */
+	void UpdateSleep(float DeltaTime, bool bCheckOverlap);
+
+	/** Counts still frames of a particle chain from its particle speeds. Called by the subsystem after the solve. */
+	void UpdateParticleSleep();
+
+	/** Counts one still or moving frame; the chain falls asleep after Profile->Sleep.SleepFrames still frames. */
+	void NotifyStillFrame(bool bStill);
+
+	/** Freezes the chain: rigid links are put to sleep, particle chains are skipped by the subsystem. */
+	void PutToSleep();
+
+	/** True if a sleeping chain must wake up. */
+	bool ShouldWake(bool bCheckOverlap) const;
+
+	/** Writes the solved particle positions back to the link transforms and components. Called by the subsystem after the solve. */
+	void ApplyParticlesToLinks();
+
+	/**
+	 * Writes link transforms from the particles of a solver chain, turning each link from its previous transform.
+	 * Shared with the subsystem's restraints so a promoted restraint continues seamlessly.
+	 */
+	static void WriteLinkTransforms(const FChainXPBDSolver& Solver, int32 ChainId, const FTransform& LinkRelative, TArrayView<FTransform> LinkTransforms);
+
+	/** Subsystem owning the particle state, null in worlds without one. */
+	UChainSimulationSubsystem* GetSimulationSubsystem() const;
+
+	/** Anchor helpers shared by the rigid body and particle paths. */
+	bool IsStartAnchorBound() const;
+	bool IsEndAnchorBound() const;
+	/** Anchor location through the subsystem's anchor tracker. OutVelocity, if set, receives the anchor velocity over the last frame. */
+	FVector ResolveAnchorLocation(const FChainAnchor& Anchor, FVector* OutVelocity = nullptr) const;
+
+	/** Builds the per-chain solver settings from a profile. */
+	static FChainSolverChainSettings MakeSolverChainSettings(const UChainProfile& InProfile);
+
+	/** Particle layout between two anchors taken from the profile's baked rest poses. False if there is none to use. */
+	bool LayoutFromRestPose(const FVector& Start, const FVector& End, TArray<FVector>& OutPositions) const;
+
+	/** Builds the particle chain world collision from a profile and a LOD level. */
+	static FChainWorldCollision MakeWorldCollision(const UChainProfile& InProfile, int32 LODIndex);
+
+	/** Id of this chain inside the subsystem solver, INDEX_NONE if not registered. */
+	int32 ParticleChainId = INDEX_NONE;
+
+	/** World transform of each link, written from the particles. Instanced chains are drawn from it. */
+	TArray<FTransform> LinkTransforms;
+
+	/** Tube buffers kept between frames, with the particle positions they are built from. */
+	FChainTubeMesh TubeBuffers;
+	TArray<FVector> TubePoints;
+
+	/** Client side key link targets, blended towards ReceivedKeyPositions. */
+	TArray<FVector> ReceivedKeyPositions;
+	TArray<FVector> ClientKeyTargets;
+
+	/** FullRep rigid links: replicated rotations, applied when the client has as many links as the server. */
+	TArray<FQuat> ReceivedKeyRotations;
+
+	/** Pose point indices currently pinned as keys, for a pose of PinnedKeyPointCount points. */
+	TArray<int32> PinnedKeyPoints;
+	int32 PinnedKeyPointCount = 0;
+
+	/** Scratch pose used by the network capture. */
+	TArray<FVector> NetPose;
+
+	/** Sleep state. Anchor locations are those of the last awake frame. */
+	bool bIsSleeping = false;
+	bool bAnchorsStill = false;
+	int32 StillFrames = 0;
+	FVector LastStartAnchorLocation = FVector::ZeroVector;
+	FVector LastEndAnchorLocation = FVector::ZeroVector;
+	FBox SleepBounds = FBox(ForceInit);
+
+	/** Compiled template serial each link body was copied from, so kept and pooled links are not copied again. */
+	TMap<TObjectKey<UStaticMeshComponent>, uint32> LinkTemplateSerials;
+
+	/** Time-sliced build progress: components configured so far by ContinueBuild. */
+	bool bBuildPending = false;
+	int32 NumBuiltLinks = 0;
+	int32 NumBuiltConstraints = 0;
+
+	/** Rest length of every segment but the first one, which absorbs reeling. */
+	float NominalSegmentLength = 0.0f;
+	float FirstSegmentLength = 0.0f;
+
 public:
 
 	/** Anchor manipulation API */
@@ -123,10 +433,36 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Chain|Anchors")
 	void SetEndAnchor(const FChainAnchor& NewAnchor);
 
-	/** Rope-like dynamic length changes (grappling hook). */
+	/**
+	 * Switches to another LOD level without rebuilding the chain: re-samples the current pose onto
+	 * the level's segment count and applies its simulation, collision and rate settings.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Chain|LOD")
+	void SetLODLevel(int32 LODIndex);
+
+	/** Changes the number of segments, re-sampling the current pose. Only the link delta is created or destroyed. */
+	UFUNCTION(BlueprintCallable, Category = "Chain")
+	void SetSegmentCount(int32 NewSegmentCount);
+
+	/**
+	 * Rope-like dynamic length changes (grappling hook, winch). The chain reels in or out at the start anchor
+	 * at Profile->ReelSpeed, without rebuilding. Requires the particle (XPBD) backend.
+	 */
 	UFUNCTION(BlueprintCallable, Category = "Chain|Dynamics")
 	void SetTargetLength(float NewLength);
 
+	/** True while the chain is asleep: no solve, no transform or render update. */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Chain|Sleep")
+	bool IsSleeping() const { return bIsSleeping; }
+
+	/** Wakes a sleeping chain up. */
+	UFUNCTION(BlueprintCallable, Category = "Chain|Sleep")
+	void WakeUp();
+
+	/** Applies an impulse (kg.cm/s) to the links within Radius of Location, waking the chain up. */
+	UFUNCTION(BlueprintCallable, Category = "Chain|Dynamics")
+	void AddImpulseAtLocation(const FVector& Impulse, const FVector& Location, float Radius = 50.0f);
+
 	/** Break an individual link constraint (destructible chain). */
 	UFUNCTION(BlueprintCallable, Category = "Chain|Dynamics")
 	void BreakLink(int32 LinkIndex);
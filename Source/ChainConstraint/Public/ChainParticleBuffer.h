@@ -0,0 +1,103 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Float storage aligned for the 4-wide vector registers used by the solver kernels. */
+using FChainFloatArray = TArray<float, TAlignedHeapAllocator<16>>;
+
+/** Index storage with the same layout. */
+using FChainIndexArray = TArray<int32, TAlignedHeapAllocator<16>>;
+
+/** Chains are allocated in blocks of this many particles so SIMD kernels never straddle two chains. */
+static constexpr int32 ChainParticleBlockSize = 8;
+
+/** Two segment capsules kept at least MinDistance apart. Segments are named by the buffer index of their first particle. */
+struct FChainSegmentPair
+{
+	int32 A = 0;
+	int32 B = 0;
+	float MinDistance = 0.0f;
+};
+
+/**
+ * Structure-of-arrays storage for the particles of one or more chains.
+ * Each chain owns a contiguous, block aligned range; unused slots are inert padding
+ * (zero inverse mass, disabled constraints) so one kernel call can cover many chains.
+ *
+ * Constraint arrays are indexed by their first particle:
+ * - distance constraint N joins particles N and N + 1
+ * - bend constraint N joins particles N and N + 2
+ * - tether N keeps particle N within TetherRest[N] of particle TetherAnchor[N]
+ * - contact N keeps the point ContactParam[N] along segment N in front of a world plane
+ */
+struct CHAINCONSTRAINT_API FChainParticleBuffer
+{
+	/** Per-particle state. */
+	FChainFloatArray PosX, PosY, PosZ;
+	FChainFloatArray PrevX, PrevY, PrevZ;
+	FChainFloatArray VelX, VelY, VelZ;
+	FChainFloatArray InvMass;
+	FChainFloatArray GravityScale;
+	FChainFloatArray Damping;
+
+	/** Distance constraints. Mask is 1 for live constraints and 0 for padding / chain boundaries. */
+	FChainFloatArray DistanceRest, DistanceCompliance, DistanceMask, DistanceLambda;
+
+	/** Bend (skip-one distance) constraints. */
+	FChainFloatArray BendRest, BendCompliance, BendMask, BendLambda;
+
+	/** Long-range attachments. TetherRest is 0 for particles without tether. */
+	FChainFloatArray TetherRest;
+	FChainIndexArray TetherAnchor;
+
+	/**
+	 * World contacts, at most one per segment: the segment capsule stays in front of the plane
+	 * dot(X, ContactNormal) >= ContactOffset, the offset including the capsule radius.
+	 */
+	FChainFloatArray ContactNX, ContactNY, ContactNZ, ContactOffset, ContactParam, ContactFriction, ContactMask;
+
+	int32 Num() const { return PosX.Num(); }
+
+	/** Appends Count inert particles (Count must be a multiple of ChainParticleBlockSize). Returns the first index. */
+	int32 AddParticles(int32 Count);
+
+	/** Turns a range back into inert padding. */
+	void ClearRange(int32 Begin, int32 Count);
+
+	/** Drops the particles from NewNum on (NewNum must be a multiple of ChainParticleBlockSize). */
+	void Truncate(int32 NewNum);
+
+	/** Releases all storage. */
+	void Empty();
+
+	FVector3f GetPosition(int32 Index) const
+	{
+		return FVector3f(PosX[Index], PosY[Index], PosZ[Index]);
+	}
+
+	void SetPosition(int32 Index, const FVector3f& Position)
+	{
+		PosX[Index] = Position.X;
+		PosY[Index] = Position.Y;
+		PosZ[Index] = Position.Z;
+	}
+
+	void SetPrevPosition(int32 Index, const FVector3f& Position)
+	{
+		PrevX[Index] = Position.X;
+		PrevY[Index] = Position.Y;
+		PrevZ[Index] = Position.Z;
+	}
+
+	void SetVelocity(int32 Index, const FVector3f& Velocity)
+	{
+		VelX[Index] = Velocity.X;
+		VelY[Index] = Velocity.Y;
+		VelZ[Index] = Velocity.Z;
+	}
+
+private:
+
+	template <typename FunctionType>
+	void ForEachArray(FunctionType&& Function);
+};
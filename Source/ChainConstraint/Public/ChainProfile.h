@@ -4,8 +4,12 @@
 #include "Engine/DataAsset.h"
 #include "Engine/EngineTypes.h" // ECollisionChannel
 #include "UObject/ObjectMacros.h"
+#include "PhysicsEngine/BodyInstance.h"
+#include "PhysicsEngine/ConstraintInstance.h"
 #include "ChainProfile.generated.h"
 
+class UMaterialInterface;
+
 /**
  * High-level classification of the chain behavior.
  * Used for presets and documentation, not hard constraints.
@@ -34,6 +38,32 @@ enum class EChainNetworkMode : uint8
 	None        UMETA(DisplayName = "No Network Replication")
 };
 
+/**
+ * Simulation backend used to drive the links of a chain instance.
+ * ChaosRigidBodies : one simulating rigid body per link and one physics constraint per joint.
+ * XPBD             : links are particles joined by distance constraints, solved by the chain module itself.
+ */
+UENUM(BlueprintType)
+enum class EChainSimulationBackend : uint8
+{
+	ChaosRigidBodies UMETA(DisplayName = "Chaos Rigid Bodies"),
+	XPBD             UMETA(DisplayName = "XPBD Particles")
+};
+
+/**
+ * How the links of a chain instance are drawn.
+ * LinkComponents : one static mesh component per link (required by the Chaos rigid body backend).
+ * Instanced      : links sharing a mesh are drawn by one instanced component per world, updated in bulk (XPBD only).
+ * Tube           : one continuous procedural tube through the particles, for ropes and cables (XPBD only).
+ */
+UENUM(BlueprintType)
+enum class EChainRenderMode : uint8
+{
+	LinkComponents UMETA(DisplayName = "Link Components"),
+	Instanced      UMETA(DisplayName = "Instanced Links"),
+	Tube           UMETA(DisplayName = "Procedural Tube")
+};
+
 /**
  * Visual and geometric settings for individual links composing the chain.
  */
@@ -46,6 +76,13 @@ struct FChainVisualSettings
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Visual")
 	TObjectPtr<UStaticMesh> LinkMesh = nullptr;
 
+	/**
+	 * Rendering path for the links. Instanced requires the XPBD backend, rigid body chains
+	 * always use one component per link.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Visual")
+	EChainRenderMode RenderMode = EChainRenderMode::LinkComponents;
+
 	/** Optional relative transform applied to each link mesh. */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Visual")
 	FTransform LinkRelativeTransform = FTransform::Identity;
@@ -61,6 +98,22 @@ struct FChainVisualSettings
 	/** If true, all segments share the same length. */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Visual")
 	bool bUniformSegmentLength = true;
+
+	/** Radius of the procedural tube, in centimeters. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Visual|Tube", meta = (ClampMin = "0.01", EditCondition = "RenderMode == EChainRenderMode::Tube"))
+	float TubeRadius = 2.0f;
+
+	/** Vertices around the tube. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Visual|Tube", meta = (ClampMin = "3", ClampMax = "32", EditCondition = "RenderMode == EChainRenderMode::Tube"))
+	int32 TubeRadialSegments = 8;
+
+	/** Rings per simulated segment, the tube follows a smooth curve through the particles. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Visual|Tube", meta = (ClampMin = "1", ClampMax = "16", EditCondition = "RenderMode == EChainRenderMode::Tube"))
+	int32 TubeSubdivisions = 2;
+
+	/** Material of the procedural tube. V runs along the tube, one unit per circumference. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Visual|Tube", meta = (EditCondition = "RenderMode == EChainRenderMode::Tube"))
+	TObjectPtr<UMaterialInterface> TubeMaterial = nullptr;
 };
 
 /**
@@ -91,9 +144,26 @@ struct FChainLinkPhysicsSettings
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Physics")
 	FName CollisionProfileName = NAME_None;
 
-	/** If true, links can collide with each other (more expensive, more realistic). */
+	/**
+	 * If true, links report hit events: OnComponentHit for rigid links, OnChainHit for particle chains.
+	 * Off by default, hit notifications on every link flood the contact pipeline of chains lying on the ground.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Physics")
+	bool bNotifyRigidBodyCollision = false;
+
+	/**
+	 * If true, links can collide with each other (more expensive, more realistic).
+	 * Particle chains collide their segment capsules (Simulation.CollisionRadius) through a spatial hash, without Chaos contacts.
+	 */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Physics")
 	bool bEnableSelfCollision = false;
+
+	/**
+	 * Chaos position solver iterations of each link body, scaled per LOD level.
+	 * Stiff joints converge without raising the project-wide iteration count. 0 = project default.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Physics", meta = (ClampMin = "0", ClampMax = "255"))
+	int32 PositionSolverIterations = 0;
 };
 
 /**
@@ -142,6 +212,121 @@ struct FChainConstraintSettings
 	float BreakTorque = 0.0f;
 };
 
+/**
+ * Settings for the particle (XPBD) simulation backend.
+ * Ignored when the profile uses Chaos rigid bodies.
+ */
+USTRUCT(BlueprintType)
+struct FChainSimulationSettings
+{
+	GENERATED_BODY()
+
+	/** Backend used to simulate chains built from this profile. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Simulation")
+	EChainSimulationBackend Backend = EChainSimulationBackend::ChaosRigidBodies;
+
+	/** Number of constraint projection iterations per substep, scaled per LOD level. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Simulation", meta = (ClampMin = "1", ClampMax = "64"))
+	int32 Iterations = 4;
+
+	/**
+	 * Number of substeps each step is split into. Substeps stiffen a chain more than iterations for the same cost;
+	 * stiff chains at low frame rates want 2-4 substeps of 1-2 iterations.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Simulation", meta = (ClampMin = "1", ClampMax = "16"))
+	int32 Substeps = 1;
+
+	/**
+	 * If > 0, chains advance in fixed steps of this duration (seconds), the frame time being accumulated in between,
+	 * so their behavior does not depend on the frame rate. 0 = one step per frame, of the frame time.
+	 * Ignored when chains are solved on the physics thread, which has its own fixed tick.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Simulation", meta = (ClampMin = "0.0", UIMax = "0.05"))
+	float FixedTimeStep = 0.0f;
+
+	/** Compliance (inverse stiffness) of the distance constraints between particles. 0 = inextensible. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Simulation", meta = (ClampMin = "0.0"))
+	float DistanceCompliance = 0.0f;
+
+	/** If true, skip-one distance constraints resist bending (stiffer chains, more cost). */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Simulation")
+	bool bEnableBendConstraints = false;
+
+	/** Compliance of the bend constraints. Higher values => floppier chain. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Simulation", meta = (ClampMin = "0.0", EditCondition = "bEnableBendConstraints"))
+	float BendCompliance = 0.001f;
+
+	/**
+	 * If true, every particle is also tethered to the closest pinned anchor and can never be farther from it
+	 * than its rest distance along the chain. Removes the stretch of long chains at 1-2 iterations (XPBD only).
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Simulation")
+	bool bEnableTethers = false;
+
+	/** Slack allowed on the tethers, as a fraction of their rest distance. 0 = the chain can never stretch past its length. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Simulation", meta = (ClampMin = "0.0", UIMax = "0.5", EditCondition = "bEnableTethers"))
+	float TetherStretch = 0.0f;
+
+	/**
+	 * If true, segments collide with the world as capsules: one overlap query per chain bounds against
+	 * Physics.CollisionChannel, then one closest point query per segment near each overlapped body.
+	 * The world is not pushed back. Disabled by LOD levels without collisions.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Simulation|Collision")
+	bool bEnableWorldCollision = false;
+
+	/**
+	 * If true, segments collide with the segments of every other particle chain with this flag (rope bridges, cargo nets).
+	 * Chains are found through one spatial hash shared by all chains; touching chains are solved together.
+	 * Only chains stepped with the same iterations and substeps collide. Disabled by LOD levels without collisions.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Simulation|Collision")
+	bool bCollideWithOtherChains = false;
+
+	/** Radius of the segment capsules, in centimeters. Used by world, self and chain-vs-chain collision. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Simulation|Collision", meta = (ClampMin = "0.1"))
+	float CollisionRadius = 2.0f;
+
+	/** Coulomb friction of the segments on the world. 0 = frictionless. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Simulation|Collision", meta = (ClampMin = "0.0", UIMax = "2.0", EditCondition = "bEnableWorldCollision"))
+	float CollisionFriction = 0.5f;
+
+	/** Multiplier applied to the world gravity. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Simulation")
+	float GravityScale = 1.0f;
+
+	/** Largest time fed to the solver in one frame, in seconds. Longer frames are clamped to avoid explosions. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Simulation", meta = (ClampMin = "0.001"))
+	float MaxDeltaTime = 1.0f / 30.0f;
+};
+
+/**
+ * Chain-level sleeping. A chain whose links and anchors stay slower than the threshold for enough
+ * consecutive frames is frozen as a whole (no solve, no transform or render update) until woken up
+ * by anchor motion, an overlapping body, an impulse or a length change.
+ */
+USTRUCT(BlueprintType)
+struct FChainSleepSettings
+{
+	GENERATED_BODY()
+
+	/** If false, chains built from this profile never sleep. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Sleep")
+	bool bAllowSleep = true;
+
+	/** Links and anchors slower than this (cm/s) count as still. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Sleep", meta = (ClampMin = "0.0", EditCondition = "bAllowSleep"))
+	float SleepSpeedThreshold = 2.0f;
+
+	/** Consecutive still frames before the chain falls asleep. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Sleep", meta = (ClampMin = "1", EditCondition = "bAllowSleep"))
+	int32 SleepFrames = 30;
+
+	/** If true, pawns and physics bodies entering the bounds of a sleeping chain wake it up (checked at a low rate). */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Sleep", meta = (EditCondition = "bAllowSleep"))
+	bool bWakeOnOverlap = true;
+};
+
 /**
  * LOD (Level Of Detail) settings for a chain profile.
  * Used to reduce cost of simulation and collisions based on distance.
@@ -174,6 +359,14 @@ struct FChainLODLevel
 	/** Optional tick rate factor for simulation (1.0 = every frame, 0.5 = every other frame, etc.). */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "LOD", meta = (ClampMin = "0.01"))
 	float SimulationRateFactor = 1.0f;
+
+	/** Scale applied to the solver iterations (XPBD iterations, rigid body position iterations) at this LOD. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "LOD", meta = (ClampMin = "0.01", ClampMax = "4.0"))
+	float IterationScale = 1.0f;
+
+	/** Caps the XPBD substeps at this LOD. 0 = profile value. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "LOD", meta = (ClampMin = "0"))
+	int32 MaxSubsteps = 0;
 };
 
 /**
@@ -199,6 +392,96 @@ struct FChainNetworkSettings
 	 */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Network", meta = (ClampMin = "0", ClampMax = "8"))
 	int32 ReplicatedKeyLinksCount = 2;
+
+	/** Key positions moving less than this (cm) since the last replicated state are not resent. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Network", meta = (ClampMin = "0.0"))
+	float KeyLinkTolerance = 1.0f;
+
+	/** How fast clients blend their key links (every link in FullRep) towards the replicated positions (1/s). 0 = snap. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Network", meta = (ClampMin = "0.0"))
+	float KeyLinkInterpSpeed = 15.0f;
+
+	/**
+	 * FullRep: bits per axis of link positions, quantized relative to the chain root over +/- 1.25x the max chain length.
+	 * 16 bits on a 10 m chain is ~0.4 mm.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Network", meta = (ClampMin = "8", ClampMax = "24"))
+	int32 FullRepPositionBits = 16;
+
+	/** FullRep: bits per component of smallest-three link rotations (rigid body chains only). */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Network", meta = (ClampMin = "6", ClampMax = "10"))
+	int32 FullRepRotationBits = 10;
+};
+
+/**
+ * Rest poses of a chain hanging between two anchors, baked so that chains spawn already settled.
+ * Poses are sampled over the anchor span (anchor distance / chain length, from 0 to MaxSpanRatio) and the pitch
+ * of the end anchor seen from the start anchor (-90 to 90 degrees). Each pose is PointsPerPose points evenly
+ * spaced along the chain, in the vertical plane through both anchors (X horizontal towards the end anchor, Y up),
+ * in units of the chain length.
+ */
+USTRUCT(BlueprintType)
+struct CHAINCONSTRAINT_API FChainRestPoseTable
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, Category = "Rest Pose")
+	int32 NumSpanSamples = 0;
+
+	UPROPERTY(VisibleAnywhere, Category = "Rest Pose")
+	int32 NumPitchSamples = 0;
+
+	UPROPERTY(VisibleAnywhere, Category = "Rest Pose")
+	int32 PointsPerPose = 0;
+
+	UPROPERTY(VisibleAnywhere, Category = "Rest Pose")
+	float MaxSpanRatio = 0.0f;
+
+	/** Poses, pitch major: pose (Span, Pitch) starts at (Pitch * NumSpanSamples + Span) * PointsPerPose. */
+	UPROPERTY()
+	TArray<FVector2f> Points;
+
+	bool IsValid() const
+	{
+		return NumSpanSamples >= 2 && NumPitchSamples >= 2 && PointsPerPose >= 2 && Points.Num() == NumSpanSamples * NumPitchSamples * PointsPerPose;
+	}
+
+	/**
+	 * Interpolates the rest pose for a span ratio and a pitch (radians) into NumPoints points.
+	 * Returns false if the table is empty or the anchors are too far apart to sag (the chain is then straight).
+	 */
+	bool Sample(float SpanRatio, float Pitch, int32 NumPoints, TArray<FVector2f>& OutPoints) const;
+};
+
+/** Collision of a rigid body link, applied to live bodies when the LOD level toggles collisions. */
+struct CHAINCONSTRAINT_API FChainLinkCollisionSetup
+{
+	ECollisionEnabled::Type CollisionEnabled = ECollisionEnabled::NoCollision;
+	ECollisionChannel ObjectType = ECC_WorldDynamic;
+	FCollisionResponseContainer Responses;
+};
+
+/**
+ * Link body and joint setup compiled once from a profile and shared by every chain built from it.
+ * Components get these bulk copied instead of one setter call per setting, each of which may update the body.
+ */
+struct CHAINCONSTRAINT_API FChainCompiledTemplate
+{
+	/** Unique per compile, links remember the template their body was copied from. */
+	uint32 Serial = 0;
+
+	/** Rigid body link: simulated, with the profile's mass, damping, collision and hit notifications. */
+	FBodyInstance SimulatedLinkBody;
+
+	/** Render-only link of particle chains: not simulated, no collision. */
+	FBodyInstance RenderLinkBody;
+
+	/** Rigid body link collision with collisions enabled (that of SimulatedLinkBody) and disabled (simulated, ignores all). */
+	FChainLinkCollisionSetup LinkCollision;
+	FChainLinkCollisionSetup IgnoredLinkCollision;
+
+	/** Limits, drives and break thresholds of the joint between two links. */
+	FConstraintProfileProperties ConstraintProfile;
 };
 
 /**
@@ -206,7 +489,7 @@ struct FChainNetworkSettings
  * visual, physical, constraint, LOD and network behavior.
  */
 UCLASS(BlueprintType)
-class YOURMODULE_API UChainProfile : public UDataAsset
+class CHAINCONSTRAINT_API UChainProfile : public UDataAsset
 {
 	GENERATED_BODY()
 
@@ -230,6 +513,14 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Chain")
 	FChainConstraintSettings Constraint;
 
+	/** Simulation backend and particle solver settings. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Chain|Simulation")
+	FChainSimulationSettings Simulation;
+
+	/** When chains built from this profile stop simulating while at rest. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Chain|Simulation")
+	FChainSleepSettings Sleep;
+
 	/** LOD levels for distance-based performance control. */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Chain|LOD")
 	TArray<FChainLODLevel> LODLevels;
@@ -249,6 +540,18 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Chain|Behavior")
 	bool bAllowDynamicLengthChange = true;
 
+	/** Reel-in / reel-out speed in cm/s used by SetTargetLength. 0 = as fast as the chain stays stable (half a segment per frame). */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Chain|Behavior", meta = (ClampMin = "0.0", EditCondition = "bAllowDynamicLengthChange"))
+	float ReelSpeed = 200.0f;
+
+	/** Shortest length the chain can be reeled in to. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Chain|Behavior", meta = (ClampMin = "0.0", EditCondition = "bAllowDynamicLengthChange"))
+	float MinLength = 0.0f;
+
+	/** Longest length the chain can be reeled out to, particles are reserved for it up front. 0 = base length. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Chain|Behavior", meta = (ClampMin = "0.0", EditCondition = "bAllowDynamicLengthChange"))
+	float MaxLength = 0.0f;
+
 	/**
 	 * If true, the chain rest pose is defined in world space (e.g. hangs under gravity).
 	 * If false, it can follow an initial authored pose when the anchors move.
@@ -256,6 +559,36 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Chain|Behavior")
 	bool bUseWorldSpaceRestPose = true;
 
+	/**
+	 * If true, particle chains between two anchors spawn in the baked rest pose, asleep when the profile allows it,
+	 * instead of on a straight line that takes many expensive frames to settle.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Chain|Rest Pose")
+	bool bUseRestPoseCache = true;
+
+	/** Anchor spans baked by BakeRestPoses. */
+	UPROPERTY(EditAnywhere, Category = "Chain|Rest Pose", meta = (ClampMin = "2", ClampMax = "32"))
+	int32 RestPoseSpanSamples = 8;
+
+	/** Anchor pitches baked by BakeRestPoses. */
+	UPROPERTY(EditAnywhere, Category = "Chain|Rest Pose", meta = (ClampMin = "2", ClampMax = "32"))
+	int32 RestPosePitchSamples = 7;
+
+	/** Points stored per baked pose. Chains with more segments are interpolated. */
+	UPROPERTY(EditAnywhere, Category = "Chain|Rest Pose", meta = (ClampMin = "3", ClampMax = "128"))
+	int32 RestPosePoints = 17;
+
+	/** Baked rest poses. */
+	UPROPERTY(VisibleAnywhere, Category = "Chain|Rest Pose")
+	FChainRestPoseTable RestPoses;
+
+	/**
+	 * Simulates the profile's chain under gravity between anchors at every sampled span and pitch until it settles,
+	 * and stores the resulting poses in RestPoses. Uses the particle solver, no world is needed.
+	 */
+	UFUNCTION(CallInEditor, Category = "Chain|Rest Pose")
+	void BakeRestPoses();
+
 public:
 
 	/** Returns the base segment count defined by the profile (ignoring LOD). */
@@ -266,6 +599,18 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Chain|Profile")
 	float GetBaseLength() const;
 
+	/** Returns the longest length the chain can be reeled out to (base length if not set or if dynamic length is disabled). */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Chain|Profile")
+	float GetMaxLength() const;
+
+	/** True if links are drawn through the subsystem's instanced components instead of one component each. */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Chain|Profile")
+	bool UsesInstancedLinks() const;
+
+	/** True if the chain is drawn as one procedural tube instead of link meshes. */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Chain|Profile")
+	bool UsesTubeMesh() const;
+
 	/**
 	 * Resolves an effective segment count for a given camera distance.
 	 * Uses LOD overrides if any LOD level matches the distance.
@@ -273,9 +618,46 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Chain|Profile")
 	int32 GetSegmentCountAtDistance(float Distance) const;
 
+	/**
+	 * Resolves the effective segment count of a LOD level.
+	 * Returns the base segment count for INDEX_NONE or levels without override.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Chain|Profile")
+	int32 GetSegmentCountForLOD(int32 LODIndex) const;
+
 	/**
 	 * Returns the LOD index used for the given distance, or INDEX_NONE if no LOD matches.
 	 */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Chain|Profile")
 	int32 GetLODIndexForDistance(float Distance) const;
+
+	/** Returns the XPBD iterations per substep of a LOD level (profile value for INDEX_NONE). */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Chain|Profile")
+	int32 GetIterationsForLOD(int32 LODIndex) const;
+
+	/** Returns the XPBD substeps of a LOD level (profile value for INDEX_NONE). */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Chain|Profile")
+	int32 GetSubstepsForLOD(int32 LODIndex) const;
+
+	/** Returns the Chaos position iterations of link bodies at a LOD level, 0 = project default. */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Chain|Profile")
+	int32 GetRigidBodyIterationsForLOD(int32 LODIndex) const;
+
+	/** Returns true if chains built from this profile are simulated by the particle (XPBD) solver. */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Chain|Profile")
+	bool UsesParticleSolver() const;
+
+	/** Link body and joint setup compiled from the current settings. Compiled on first use, then cached. */
+	const FChainCompiledTemplate& GetCompiledTemplate() const;
+
+	/** Drops the compiled template; to be called after changing physics or constraint settings at runtime. */
+	void InvalidateCompiledTemplate() { CompiledTemplate.Reset(); }
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+private:
+
+	mutable TSharedPtr<const FChainCompiledTemplate> CompiledTemplate;
 };
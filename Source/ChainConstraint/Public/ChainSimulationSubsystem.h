@@ -0,0 +1,411 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/EngineTypes.h"
+#include "Engine/OverlapResult.h"
+#include "ChainXPBDSolver.h"
+#include "ChainAnchorTracker.h"
+#include "ChainInstanceActor.h"
+#include "ChainSimulationSubsystem.generated.h"
+
+class FChainAsyncSimulation;
+class UChainProfile;
+class UInstancedStaticMeshComponent;
+class UPrimitiveComponent;
+class UStaticMesh;
+
+/** World collision of one registered chain: its segments, as capsules, against the blocking geometry of a channel. */
+struct FChainWorldCollision
+{
+	bool bEnabled = false;
+	float Radius = 2.0f;
+	float Friction = 0.5f;
+	ECollisionChannel Channel = ECC_PhysicsBody;
+
+	/** Reports segments starting to touch the world to the chain actor. */
+	bool bNotifyHits = false;
+
+	/** Also keeps the segments apart from those of the other chains with this flag. */
+	bool bCollideWithChains = false;
+};
+
+/**
+ * Handle of a restraint entity (see UChainSimulationSubsystem::AddRestraint).
+ * Handles of a removed or promoted restraint no longer resolve, even once its slot is reused.
+ */
+USTRUCT(BlueprintType)
+struct FChainRestraintHandle
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int32 Slot = INDEX_NONE;
+
+	UPROPERTY()
+	uint32 Serial = 0;
+};
+
+/** Instanced component drawing every link of one mesh, with the transforms gathered this frame. */
+USTRUCT()
+struct FChainLinkInstanceBatch
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TObjectPtr<UInstancedStaticMeshComponent> Component = nullptr;
+
+	TArray<FTransform> Transforms;
+
+	/** A chain drawn by this batch moved this frame, its instances are uploaded. */
+	bool bDirty = false;
+};
+
+/**
+ * Owns the particle state of every XPBD chain in the world and advances all of them once per frame:
+ * - build : queued time-sliced chain builds continue, oldest first, within Chain.Build.BudgetMs
+ * - LOD   : every chain actor is assigned a LOD level from the closest view, at a fixed cadence
+ * - network: servers capture replicated key links, clients blend their key targets towards them
+ * - sleep : chains at rest are skipped entirely until anchor motion, an overlap or an impulse wakes them
+ * - gather: each chain pushes its anchor targets into the shared buffer, with the anchor velocity; anchors shared by
+ *           several chains are resolved once per frame by the anchor tracker
+ * - collision: one overlap query per colliding chain bounds, then per segment contacts against the overlapped bodies;
+ *              chains touching each other (shared spatial hash over all their segments) are solved as one island
+ * - solve : contiguous chains are grouped into islands, islands are solved in one ParallelFor,
+ *           or on the physics thread at the fixed physics tick when Chain.Simulation.Async is set
+ * - budget: over Chain.Simulation.BudgetMs, far chains lose substeps and iterations, then skip a frame
+ * - write back: each chain applies its solved pose to its links, in a single pass
+ * - instances: links of instanced chains are uploaded in bulk, one instanced component per link mesh
+ * - restraints: small chains with no actor (shackles on crowds) are entities of packed fragment arrays, anchored
+ *               and written back in batch passes, until promoted to a full chain actor
+ */
+UCLASS()
+class CHAINCONSTRAINT_API UChainSimulationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/**
+	 * Adds a chain passing through the given particle positions to the shared solver.
+	 * Returns the chain id used by every other call, INDEX_NONE on failure.
+	 */
+	int32 RegisterChain(AChainInstanceActor* Chain, TConstArrayView<FVector> Positions, const FChainSolverChainSettings& Settings, int32 Iterations, int32 Substeps, float MaxDeltaTime, float FixedTimeStep);
+
+	/** Removes a chain from the shared solver. */
+	void UnregisterChain(int32 ChainId);
+
+	/**
+	 * Controls how often and how finely a registered chain is stepped.
+	 * RateFactor 1 = every frame, 0.5 = every other frame with the accumulated time, etc.
+	 * Each step is split into Substeps, each running Iterations constraint iterations.
+	 */
+	void SetChainStepping(int32 ChainId, bool bSimulate, float RateFactor, int32 Iterations, int32 Substeps);
+
+	/** Enables, disables or changes the world collision of a registered chain. */
+	void SetChainCollision(int32 ChainId, const FChainWorldCollision& Collision);
+
+	/** Adds a chain actor (any backend) to the LOD manager. */
+	void RegisterChainActor(AChainInstanceActor* Chain);
+
+	/** Removes a chain actor from the LOD manager. */
+	void UnregisterChainActor(AChainInstanceActor* Chain);
+
+	/** Queues a chain actor whose build is spread over frames, within Chain.Build.BudgetMs. */
+	void QueueChainBuild(AChainInstanceActor* Chain);
+
+	/**
+	 * Adds a restraint: a small particle chain between two anchors with no actor or UObject of its own, drawn by
+	 * the instanced link components. The profile must use the particle solver and instanced links.
+	 * Returns an unset handle on failure.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Chain|Restraints")
+	FChainRestraintHandle AddRestraint(UChainProfile* Profile, const FChainAnchor& StartAnchor, const FChainAnchor& EndAnchor);
+
+	/** Removes a restraint and its particles. */
+	UFUNCTION(BlueprintCallable, Category = "Chain|Restraints")
+	void RemoveRestraint(FChainRestraintHandle Handle);
+
+	/** Changes what the ends of a restraint follow. Unbound anchors leave their end free. */
+	UFUNCTION(BlueprintCallable, Category = "Chain|Restraints")
+	void SetRestraintAnchors(FChainRestraintHandle Handle, const FChainAnchor& StartAnchor, const FChainAnchor& EndAnchor);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Chain|Restraints")
+	bool IsValidRestraint(FChainRestraintHandle Handle) const { return FindRestraint(Handle) != INDEX_NONE; }
+
+	/**
+	 * Replaces a restraint by a chain actor with the same profile and anchors, continuing from the restraint's
+	 * current pose, e.g. when a player starts interacting with it. The handle is invalid afterwards.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Chain|Restraints")
+	AChainInstanceActor* PromoteRestraint(FChainRestraintHandle Handle);
+
+	/** Number of restraint entities. */
+	int32 GetNumRestraints() const { return Restraints.ChainIds.Num(); }
+
+	/** Shared solver, valid for chain ids returned by RegisterChain. */
+	FChainXPBDSolver& GetSolver() { return Solver; }
+	const FChainXPBDSolver& GetSolver() const { return Solver; }
+
+	/** Anchor locations shared by the chains of this world, evaluated at most once per frame. */
+	FChainAnchorTracker& GetAnchorTracker() { return AnchorTracker; }
+
+	/**
+	 * Drives a pinned particle with an anchor moving at Velocity: the particle sweeps to Location over the chain's
+	 * step this frame instead of jumping there before it.
+	 */
+	void SetAnchorTarget(int32 ChainId, int32 Particle, const FVector& Location, const FVector& Velocity);
+
+	/** Number of chains currently registered. */
+	int32 GetNumChains() const { return Chains.Num(); }
+
+	/** True while the chains are solved on the async physics thread. */
+	bool IsSimulatingAsync() const { return AsyncSimulation.IsValid(); }
+
+	/** Wall time of the last Tick (LOD, network, solve, write back), in seconds. */
+	double GetLastTickTime() const { return LastTickTime; }
+
+private:
+
+	/** Bookkeeping for one registered chain. */
+	struct FRegisteredChain
+	{
+		TWeakObjectPtr<AChainInstanceActor> Actor;
+		int32 Iterations = 4;
+		int32 Substeps = 1;
+		float MaxDeltaTime = 1.0f / 30.0f;
+		float FixedTimeStep = 0.0f;
+
+		/** LOD driven stepping. */
+		bool bSimulate = true;
+		float RateFactor = 1.0f;
+		float RateAccumulator = 0.0f;
+		float PendingDeltaTime = 0.0f;
+		bool bSteppedThisFrame = false;
+
+		/** Time the chain is stepped by this frame, 0 when stepped on the physics thread. */
+		float StepTime = 0.0f;
+
+		/** Distance to the closest view, as of the last LOD update. Far chains are degraded first when over budget. */
+		float ViewDistance = 0.0f;
+		bool bDeferredLastFrame = false;
+
+		/** World collision, with the segments in contact as of the last query. */
+		FChainWorldCollision Collision;
+		TBitArray<> ContactSegments;
+
+		/** Owned by a restraint entity rather than an actor. */
+		bool bRestraint = false;
+	};
+
+	/** End of a restraint: a component / socket followed through a weak reference, or a fixed world location. */
+	struct FChainRestraintAnchor
+	{
+		TWeakObjectPtr<USceneComponent> Component;
+		FName SocketName = NAME_None;
+		FVector WorldLocation = FVector::ZeroVector;
+		bool bUseWorldLocation = false;
+
+		FChainRestraintAnchor() = default;
+		explicit FChainRestraintAnchor(const FChainAnchor& Anchor);
+
+		bool IsBound() const { return bUseWorldLocation || Component.IsValid(); }
+		/** Followed a component that has since been destroyed. */
+		bool IsStale() const { return !bUseWorldLocation && !Component.IsExplicitlyNull() && !Component.IsValid(); }
+		FVector Resolve(FChainAnchorTracker& Tracker, FVector* OutVelocity = nullptr) const;
+		FChainAnchor ToChainAnchor() const;
+	};
+
+	/**
+	 * Restraint entities as fragment arrays, one entry per restraint in entity order. Particles live in the shared
+	 * solver buffer; link transforms of every restraint are packed in entity order. Handles resolve through slots,
+	 * so entities stay packed when one is removed.
+	 */
+	struct FChainRestraintFragments
+	{
+		TArray<int32> ChainIds;
+		TArray<int32> ProfileIndices;
+		TArray<FChainRestraintAnchor> StartAnchors;
+		TArray<FChainRestraintAnchor> EndAnchors;
+		TArray<int32> LinkBegins;
+		TArray<int32> Slots;
+
+		TArray<FTransform> LinkTransforms;
+
+		/** Entity of each handle slot (INDEX_NONE when free) and the serial handles must match. */
+		TArray<int32> SlotEntities;
+		TArray<uint32> SlotSerials;
+		TArray<int32> FreeSlots;
+
+		int32 GetNumLinks(int32 Entity) const
+		{
+			return (Entity + 1 < LinkBegins.Num() ? LinkBegins[Entity + 1] : LinkTransforms.Num()) - LinkBegins[Entity];
+		}
+	};
+
+	/** Segment that started touching the world, reported after the write back. */
+	struct FPendingChainHit
+	{
+		TWeakObjectPtr<AChainInstanceActor> Actor;
+		TWeakObjectPtr<UPrimitiveComponent> OtherComponent;
+		FVector Location = FVector::ZeroVector;
+		FVector Normal = FVector::ZeroVector;
+		int32 Segment = INDEX_NONE;
+	};
+
+	/** Chain due for a step this frame, before the budget is applied. */
+	struct FStepCandidate
+	{
+		int32 ChainId = INDEX_NONE;
+		int32 Iterations = 1;
+		int32 NumSubsteps = 1;
+		float SubstepDeltaTime = 0.0f;
+
+		/** Time taken from the chain's pending time if stepped. */
+		float ConsumedTime = 0.0f;
+
+		/** Particles x iterations x substeps. */
+		double Cost = 0.0;
+		float ViewDistance = 0.0f;
+		bool bDeferred = false;
+	};
+
+	/** Contiguous particle range solved as one task, or a collision group when Group is set. */
+	struct FChainIsland
+	{
+		int32 Begin = 0;
+		int32 End = 0;
+		int32 Iterations = 0;
+		int32 NumSubsteps = 1;
+		float SubstepDeltaTime = 0.0f;
+		int32 Group = INDEX_NONE;
+	};
+
+	/** Chains whose segments touch each other this frame, stepped together with their cross-chain segment pairs. */
+	struct FChainCollisionGroup
+	{
+		TArray<FChainParticleSpan> Spans;
+		TArray<FChainSegmentPair> Pairs;
+		int32 NumParticles = 0;
+
+		/** Step parameters, shared by every chain of the group. */
+		int32 Iterations = 0;
+		int32 NumSubsteps = 1;
+		float SubstepDeltaTime = 0.0f;
+	};
+
+	/** Segment of a chain colliding with other chains, as entered in the shared broadphase. */
+	struct FChainCollisionSegment
+	{
+		int32 Candidate = INDEX_NONE;
+		int32 Particle = 0;
+		float Radius = 0.0f;
+		FBox3f Bounds;
+	};
+
+	/** Adds a chain to the shared solver with its stepping parameters, for an actor or a restraint. */
+	int32 AddSolverChain(TConstArrayView<FVector> Positions, const FChainSolverChainSettings& Settings, int32 Iterations, int32 Substeps, float MaxDeltaTime, float FixedTimeStep);
+
+	/** Entity index of a restraint handle, INDEX_NONE if it no longer resolves. */
+	int32 FindRestraint(FChainRestraintHandle Handle) const;
+
+	/** Removes a restraint entity, keeping the others packed. */
+	void RemoveRestraintAt(int32 Entity);
+
+	/** Restraint pass before the solve: unpins ends whose anchor component is gone, moves the pinned ends of the stepped restraints to their anchors. */
+	void PushRestraintAnchors();
+
+	/** Restraint pass after the solve: writes the link transforms of the stepped restraints from their particles. */
+	void UpdateRestraintLinks();
+
+	/** Writes the link transforms of one restraint. */
+	void WriteRestraintLinks(int32 Entity);
+
+	/** Continues the queued chain builds, in request order, until the frame's build budget is spent. */
+	void UpdatePendingBuilds();
+
+	/** Evaluates view distance of every chain actor and switches LOD levels, at the configured cadence. */
+	void UpdateLODs(float DeltaTime);
+
+	/** Decides which chains step this frame and groups them into islands sharing the same step parameters. */
+	void BuildIslands(float DeltaTime);
+
+	/**
+	 * Shared broadphase over the segments of every step candidate colliding with other chains: finds the segment
+	 * pairs of distinct chains whose bounds overlap and groups the chains they join. Chains only join chains with
+	 * the same step parameters.
+	 */
+	void BuildCollisionGroups();
+
+	/** Builds the world contacts of the colliding chains stepped this frame. */
+	void UpdateWorldContacts(float DeltaTime);
+
+	/** Degrades the step candidates, farthest first, until the predicted solve time fits Chain.Simulation.BudgetMs. */
+	void ApplySolveBudget();
+
+	/** Gathers the link transforms of instanced chains and uploads them, per mesh, to the instanced components. */
+	void UpdateLinkInstances();
+
+	/** Creates the instanced component drawing the links of a mesh. */
+	FChainLinkInstanceBatch& AddLinkInstanceBatch(UStaticMesh* Mesh);
+
+	/** Moves the solve to the physics thread, or back, following Chain.Simulation.Async and the physics scene settings. */
+	void UpdateAsyncSimulation();
+
+	/** Sends this frame's islands to the physics thread and pulls the poses it produced back into the solver. */
+	void SolveAsync();
+
+	FChainXPBDSolver Solver;
+	FChainAnchorTracker AnchorTracker;
+	TMap<int32, FRegisteredChain> Chains;
+	TArray<FChainIsland> Islands;
+	TArray<FStepCandidate> StepCandidates;
+
+	/** World collision scratch, reused across chains and frames. */
+	TArray<FOverlapResult> ContactOverlaps;
+	TArray<FVector> ContactPoints;
+	TArray<FChainSegmentContact> SegmentContacts;
+	TArray<FPendingChainHit> PendingHits;
+
+	/** Chain-vs-chain collision: this frame's groups, the group of each step candidate and the broadphase scratch. */
+	TArray<FChainCollisionGroup> CollisionGroups;
+	TArray<int32> CandidateGroups;
+	TArray<FChainCollisionSegment> CollisionSegments;
+	TArray<FVector3f> CollisionMiddles;
+	FChainSpatialHash CollisionHash;
+
+	/** Measured game thread solve cost, in milliseconds per particle, iteration and substep. */
+	double SolveMsPerCostUnit = 0.0;
+
+	/** Physics thread solve, only while async simulation is active. The solver records its commands for it. */
+	TSharedPtr<FChainAsyncSimulation> AsyncSimulation;
+
+	/** Every chain actor in the world, for LOD evaluation. */
+	TArray<TWeakObjectPtr<AChainInstanceActor>> ChainActors;
+	float TimeSinceLODUpdate = 0.0f;
+
+	/** Chain actors with a pending time-sliced build, oldest first. */
+	TArray<TWeakObjectPtr<AChainInstanceActor>> PendingBuilds;
+
+	/** Restraint entities, and the profiles they reference by index. */
+	FChainRestraintFragments Restraints;
+
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UChainProfile>> RestraintProfiles;
+	float TimeSinceWakeOverlapCheck = 0.0f;
+	double LastTickTime = 0.0;
+
+	/** Transient actor owning the instanced link components, spawned on first use. */
+	UPROPERTY(Transient)
+	TObjectPtr<AActor> InstanceHost = nullptr;
+
+	UPROPERTY(Transient)
+	TMap<TObjectPtr<UStaticMesh>, FChainLinkInstanceBatch> LinkInstances;
+
+	/** Set when chains are added or removed, forces an upload of every instance batch. */
+	bool bLinkInstancesDirty = false;
+};
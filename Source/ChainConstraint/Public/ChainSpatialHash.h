@@ -0,0 +1,82 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Algo/Sort.h"
+
+/**
+ * Uniform grid over points, hashed into a power of two table of buckets. Used as collision broadphase:
+ * items are bucketed by the cell of their center, a query visits the buckets of the 27 cells around a point.
+ * Distinct cells may share a bucket, so queries can return items that are not actually close.
+ */
+class CHAINCONSTRAINT_API FChainSpatialHash
+{
+public:
+
+	/**
+	 * Buckets Points with the given cell size. If the point count and the cell size did not change and every
+	 * point stayed in its cell, the table is kept and false is returned: queries would return the same items.
+	 */
+	bool Build(TConstArrayView<FVector3f> Points, float InCellSize);
+
+	/** Forgets the table, the next Build always rebuilds it. */
+	void Reset();
+
+	/** Calls Visitor(ItemIndex) once for every item in the buckets of the 27 cells around Point. */
+	template <typename VisitorType>
+	void ForEachNeighbour(const FVector3f& Point, VisitorType&& Visitor) const
+	{
+		if (BucketStarts.Num() == 0) return;
+
+		// Neighbouring cells may share a bucket, visit each bucket once
+		const FIntVector Cell = GetCell(Point);
+		uint32 Buckets[27];
+		int32 NumBuckets = 0;
+		for (int32 Z = -1; Z <= 1; ++Z)
+		{
+			for (int32 Y = -1; Y <= 1; ++Y)
+			{
+				for (int32 X = -1; X <= 1; ++X)
+				{
+					Buckets[NumBuckets++] = GetBucket(Cell + FIntVector(X, Y, Z));
+				}
+			}
+		}
+		Algo::Sort(MakeArrayView(Buckets, NumBuckets));
+
+		for (int32 Index = 0; Index < NumBuckets; ++Index)
+		{
+			const uint32 Bucket = Buckets[Index];
+			if (Index > 0 && Bucket == Buckets[Index - 1]) continue;
+
+			for (int32 Entry = BucketStarts[Bucket]; Entry < BucketStarts[Bucket + 1]; ++Entry)
+			{
+				Visitor(Items[Entry]);
+			}
+		}
+	}
+
+	FIntVector GetCell(const FVector3f& Point) const
+	{
+		return FIntVector(FMath::FloorToInt32(Point.X * InvCellSize), FMath::FloorToInt32(Point.Y * InvCellSize), FMath::FloorToInt32(Point.Z * InvCellSize));
+	}
+
+	float GetCellSize() const { return CellSize; }
+
+private:
+
+	uint32 GetBucket(const FIntVector& Cell) const
+	{
+		return ((static_cast<uint32>(Cell.X) * 73856093u) ^ (static_cast<uint32>(Cell.Y) * 19349663u) ^ (static_cast<uint32>(Cell.Z) * 83492791u)) & BucketMask;
+	}
+
+	float CellSize = 0.0f;
+	float InvCellSize = 0.0f;
+	uint32 BucketMask = 0;
+
+	/** Items of bucket B are Items[BucketStarts[B], BucketStarts[B + 1]). */
+	TArray<int32> BucketStarts;
+	TArray<int32> Items;
+
+	/** Cell of every item as of the last Build. */
+	TArray<FIntVector> ItemCells;
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+/**
+ * Chain stats, "stat Chain" in the console.
+ * Counters are reset every frame: chain and link counts are set by the simulation subsystem,
+ * rebuilds, world contacts and replicated bytes accumulate over the frame.
+ */
+DECLARE_STATS_GROUP(TEXT("Chain"), STATGROUP_Chain, STATCAT_Advanced);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Active Chains"), STAT_ChainActiveChains, STATGROUP_Chain, CHAINCONSTRAINT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Active Links"), STAT_ChainActiveLinks, STATGROUP_Chain, CHAINCONSTRAINT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Sleeping Chains"), STAT_ChainSleepingChains, STATGROUP_Chain, CHAINCONSTRAINT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Rebuilds"), STAT_ChainRebuilds, STATGROUP_Chain, CHAINCONSTRAINT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Budget Degraded Chains"), STAT_ChainBudgetDegraded, STATGROUP_Chain, CHAINCONSTRAINT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("World Contacts"), STAT_ChainWorldContacts, STATGROUP_Chain, CHAINCONSTRAINT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Chain-Chain Segment Pairs"), STAT_ChainCrossPairs, STATGROUP_Chain, CHAINCONSTRAINT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Tracked Anchor Components"), STAT_ChainTrackedAnchors, STATGROUP_Chain, CHAINCONSTRAINT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Replicated Bytes"), STAT_ChainReplicatedBytes, STATGROUP_Chain, CHAINCONSTRAINT_API);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Gather"), STAT_ChainGather, STATGROUP_Chain, CHAINCONSTRAINT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("World Collision"), STAT_ChainWorldCollision, STATGROUP_Chain, CHAINCONSTRAINT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Solve"), STAT_ChainSolve, STATGROUP_Chain, CHAINCONSTRAINT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Write Back"), STAT_ChainWriteBack, STATGROUP_Chain, CHAINCONSTRAINT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Instance Upload"), STAT_ChainInstanceUpload, STATGROUP_Chain, CHAINCONSTRAINT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Build Chain"), STAT_ChainBuild, STATGROUP_Chain, CHAINCONSTRAINT_API);
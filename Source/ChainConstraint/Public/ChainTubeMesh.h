@@ -0,0 +1,36 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProceduralMeshComponent.h"
+
+/**
+ * Vertex and index buffers of a tube swept along a polyline.
+ * The polyline is smoothed with a Catmull-Rom curve and the rings are oriented with parallel transported
+ * frames, so the tube does not twist as the rope moves. Buffers are kept between builds: only the vertex
+ * data is rewritten every frame, the index buffer only when the ring layout changes.
+ */
+struct CHAINCONSTRAINT_API FChainTubeMesh
+{
+	TArray<FVector> Vertices;
+	TArray<FVector> Normals;
+	TArray<FVector2D> UVs;
+	TArray<FProcMeshTangent> Tangents;
+	TArray<int32> Triangles;
+
+	/**
+	 * Sweeps the tube along Points, with Subdivisions rings per polyline segment and RadialSegments vertices per ring.
+	 * Returns true if the topology changed, in which case the mesh section must be re-created rather than updated.
+	 */
+	bool Build(TConstArrayView<FVector> Points, float Radius, int32 RadialSegments, int32 Subdivisions);
+
+	/** Releases every buffer. */
+	void Reset();
+
+private:
+
+	/** Ring centers along the smoothed curve. */
+	TArray<FVector> Centers;
+
+	int32 NumRings = 0;
+	int32 NumRadialSegments = 0;
+};
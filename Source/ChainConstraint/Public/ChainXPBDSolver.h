@@ -0,0 +1,262 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ChainParticleBuffer.h"
+#include "ChainSpatialHash.h"
+
+/** Per-chain parameters written into the particle buffer when a chain is added or reconfigured. */
+struct FChainSolverChainSettings
+{
+	float ParticleMass = 1.0f;
+	float DistanceCompliance = 0.0f;
+	bool bEnableBending = false;
+	float BendCompliance = 0.0f;
+	float Damping = 0.0f;
+	float GravityScale = 1.0f;
+
+	/**
+	 * Long-range attachments: every free particle is kept within its along-chain rest distance
+	 * of the closest pinned particle, which bounds the stretch whatever the iteration count.
+	 */
+	bool bEnableTethers = false;
+
+	/** Slack allowed on tethers, as a fraction of their rest distance. */
+	float TetherStretch = 0.0f;
+
+	/** Keeps the segment capsules of the chain apart from each other (coils, piles), neighbouring segments excepted. */
+	bool bEnableSelfCollision = false;
+
+	/** Radius of the segment capsules, in centimeters. */
+	float CollisionRadius = 2.0f;
+
+	/** Particles reserved for the chain, to grow it in place. 0 = exactly the initial particle count. */
+	int32 MaxParticles = 0;
+};
+
+/** Contact of one segment capsule with a world plane. */
+struct FChainSegmentContact
+{
+	/** Segment in contact: segment N spans particles N and N + 1. */
+	int32 Segment = 0;
+
+	/** Contact point along the segment, 0 = particle N, 1 = particle N + 1. */
+	float Param = 0.5f;
+
+	/** The contact point is kept in front of the plane dot(X, Normal) >= Offset. Offset includes the capsule radius. */
+	FVector3f Normal = FVector3f::UpVector;
+	float Offset = 0.0f;
+};
+
+/** Block aligned particle range [Begin, End). */
+struct FChainParticleSpan
+{
+	int32 Begin = 0;
+	int32 End = 0;
+};
+
+class FChainXPBDSolver;
+
+/** Solver mutation recorded on one solver and replayed on a mirror of it. */
+using FChainSolverCommand = TFunction<void(FChainXPBDSolver&)>;
+
+/**
+ * Particle-based chain solver (XPBD).
+ * A chain is a list of particles joined by distance constraints; link N spans particles N and N + 1.
+ * Particles of every chain added to the solver share one structure-of-arrays buffer, so a single
+ * kernel call per stage advances all of them. No Chaos body or joint is created.
+ * Pinned particles have zero inverse mass and follow kinematic targets.
+ */
+class CHAINCONSTRAINT_API FChainXPBDSolver
+{
+public:
+
+	/** Adds a chain passing through the given particle positions. Returns the chain id. */
+	int32 AddChain(TConstArrayView<FVector> InPositions, const FChainSolverChainSettings& Settings);
+
+	/** Releases a chain's particles. Its range is recycled by later AddChain calls. */
+	void RemoveChain(int32 ChainId);
+
+	/** Removes every chain and releases the buffer. */
+	void Reset();
+
+	/**
+	 * Lays a chain out again in place with a new particle count, e.g. on a LOD switch. Every segment gets RestLength.
+	 * The end particles stay pinned if they were, inner pins are released. Returns false, leaving the chain as it was,
+	 * if the chain's reserved range is too small.
+	 */
+	bool ResizeChain(int32 ChainId, TConstArrayView<FVector3f> Positions, TConstArrayView<FVector3f> Velocities, float RestLength);
+
+	/** Rewrites mass, compliance, damping and gravity of an existing chain. */
+	void ConfigureChain(int32 ChainId, const FChainSolverChainSettings& Settings);
+
+	/** Sets the rest length of every segment of a chain (bend constraints use twice that length). */
+	void SetSegmentRestLength(int32 ChainId, float RestLength);
+
+	/** Sets the rest length of the first segment only (the one attached to the start particle). */
+	void SetFirstSegmentRestLength(int32 ChainId, float RestLength);
+
+	/**
+	 * Inserts a particle right after the start particle, in O(1), using the chain's reserved room.
+	 * The first segment is split into FirstRestLength and SecondRestLength. Returns false when the chain is full.
+	 */
+	bool InsertParticleAtStart(int32 ChainId, float FirstRestLength, float SecondRestLength);
+
+	/**
+	 * Removes the particle right after the start particle, in O(1). The start particle is joined to the
+	 * next one with FirstRestLength. Returns false if the chain would drop below two segments.
+	 */
+	bool RemoveParticleAtStart(int32 ChainId, float FirstRestLength);
+
+	/** Number of constraint projection iterations per step. */
+	void SetIterations(int32 InIterations);
+
+	/** Pins or releases a particle. Pinned particles are driven by SetKinematicTarget. */
+	void SetParticlePinned(int32 ChainId, int32 Index, bool bPinned);
+
+	/**
+	 * Moves a pinned particle to a new world location, from where the following steps carry it on at Velocity.
+	 * Ignored for free particles.
+	 */
+	void SetKinematicTarget(int32 ChainId, int32 Index, const FVector& Location, const FVector& Velocity = FVector::ZeroVector);
+
+	/** Replaces the world contacts of a chain, solved by every following step. An empty list clears them. */
+	void SetSegmentContacts(int32 ChainId, TConstArrayView<FChainSegmentContact> Contacts, float Friction);
+
+	/** Advances every chain by DeltaTime seconds. */
+	void Step(float DeltaTime, const FVector& Gravity);
+
+	/**
+	 * Advances the chains stored in the block aligned particle range [Begin, End).
+	 * Disjoint ranges can be stepped concurrently.
+	 */
+	void StepRange(int32 Begin, int32 End, float DeltaTime, const FVector& Gravity, int32 NumIterations);
+
+	/**
+	 * Advances several particle ranges as one, also projecting CrossPairs (segment pairs spanning two ranges)
+	 * every iteration. Used for chains colliding with each other. Disjoint sets of ranges can be stepped concurrently.
+	 */
+	void StepRanges(TConstArrayView<FChainParticleSpan> Spans, TConstArrayView<FChainSegmentPair> CrossPairs, float DeltaTime, const FVector& Gravity, int32 NumIterations);
+
+	/** Block aligned particle range [OutBegin, OutEnd) owned by a chain. */
+	void GetChainRange(int32 ChainId, int32& OutBegin, int32& OutEnd) const
+	{
+		const FChainRange& Range = Chains[ChainId];
+		OutBegin = Range.Begin;
+		OutEnd = Range.Begin + Range.Capacity;
+	}
+
+	bool IsValidChain(int32 ChainId) const { return Chains.IsValidIndex(ChainId); }
+	int32 GetNumParticles(int32 ChainId) const { return Chains[ChainId].NumParticles; }
+
+	/** Buffer index of the first live particle of a chain. */
+	int32 GetFirstParticle(int32 ChainId) const { return Chains[ChainId].First(); }
+	FVector GetParticlePosition(int32 ChainId, int32 Index) const { return FVector(Buffer.GetPosition(Chains[ChainId].First() + Index)); }
+
+	/** Copies the particle positions of a chain. */
+	void GetParticlePositions(int32 ChainId, TArray<FVector>& OutPositions) const;
+
+	/** Squared speed of the fastest particle of a chain, as of the last step. */
+	float GetMaxSpeedSquared(int32 ChainId) const;
+
+	/** Adds DeltaVelocity to the free particles of a chain within Radius of Location. */
+	void AddVelocity(int32 ChainId, const FVector& Location, float Radius, const FVector& DeltaVelocity);
+
+	/** Copies the particle positions and velocities of a chain. */
+	void GetParticleState(int32 ChainId, TArray<FVector3f>& OutPositions, TArray<FVector3f>& OutVelocities) const;
+
+	/**
+	 * Overwrites the particle positions and velocities of a chain, e.g. with the results of a mirror solver.
+	 * Ignored if the particle count does not match. Not recorded.
+	 */
+	void SetParticleState(int32 ChainId, TConstArrayView<FVector3f> Positions, TConstArrayView<FVector3f> Velocities);
+
+	/**
+	 * Changes whenever the particle layout of a chain changes (added, particle inserted or removed).
+	 * Two solvers fed the same commands report the same revisions.
+	 */
+	uint32 GetChainRevision(int32 ChainId) const { return Chains[ChainId].Revision; }
+
+	/**
+	 * Records every mutation (chains, pins, targets, rest lengths, impulses, contacts) into Queue, in call order,
+	 * so that a mirror solver owned by another thread can replay them and keep the same layout.
+	 * Stepping is not recorded. nullptr stops recording.
+	 */
+	void SetCommandRecording(TArray<FChainSolverCommand>* Queue) { RecordedCommands = Queue; }
+
+	const FChainParticleBuffer& GetBuffer() const { return Buffer; }
+
+private:
+
+	/**
+	 * Slice of the particle buffer owned by one chain.
+	 * Live particles are [Begin + Head, Begin + Head + NumParticles), the slots before them are inert head room.
+	 */
+	struct FChainRange
+	{
+		int32 Begin = 0;
+		int32 Head = 0;
+		int32 NumParticles = 0;
+		int32 Capacity = 0;
+		float InvMass = 1.0f;
+		bool bBending = false;
+		bool bTethers = false;
+		float TetherScale = 1.0f;
+		uint32 Revision = 0;
+
+		int32 First() const { return Begin + Head; }
+		int32 Last() const { return Begin + Head + NumParticles - 1; }
+	};
+
+	/** Self collision state of one chain: spatial hash over its segment middles and the candidate pairs it gives. */
+	struct FChainSelfCollision
+	{
+		int32 ChainId = INDEX_NONE;
+		int32 Begin = 0;
+		float Radius = 0.0f;
+		FChainSpatialHash Hash;
+		TArray<FVector3f> Middles;
+		TArray<FChainSegmentPair> Pairs;
+	};
+
+	/** Returns the first index of a free block aligned range of Capacity particles. */
+	int32 AllocateRange(int32 Capacity);
+
+	/** Returns a range to the free list, merged with its free neighbours. A free range at the end of the buffer is trimmed. */
+	void ReleaseRange(int32 Begin, int32 Capacity);
+
+	/** Recomputes the tether anchor and rest distance of every particle of a chain from its pins and rest lengths. */
+	void UpdateTethers(const FChainRange& Range);
+
+	/**
+	 * Rehashes the segments of a self colliding chain at their predicted positions. Candidate pairs are only
+	 * regenerated when a segment changed cell, neighbours within two capsule radii along the chain are skipped.
+	 */
+	void UpdateSelfCollision(FChainSelfCollision& SelfCollision);
+
+	/** Copies the per-particle state (not the constraints) of one slot to another. */
+	void CopyParticle(int32 From, int32 To);
+
+	/** Appends a mutation to the recording queue, if any. */
+	template <typename LambdaType>
+	void RecordCommand(LambdaType&& Lambda)
+	{
+		if (RecordedCommands)
+		{
+			RecordedCommands->Emplace(Forward<LambdaType>(Lambda));
+		}
+	}
+
+	FChainParticleBuffer Buffer;
+	TSparseArray<FChainRange> Chains;
+
+	/** Ranges released by RemoveChain, sorted by Begin, never adjacent, reused first-fit. */
+	TArray<FChainRange> FreeRanges;
+
+	/** Self colliding chains, sorted by range so StepRange finds those it covers. */
+	TArray<FChainSelfCollision> SelfCollisions;
+
+	int32 Iterations = 4;
+	uint32 NextRevision = 0;
+
+	TArray<FChainSolverCommand>* RecordedCommands = nullptr;
+};
@@ -11,6 +11,7 @@ public class RopeStressTestsTarget : TargetRules
 		DefaultBuildSettings = BuildSettingsVersion.V6;
 		IncludeOrderVersion = EngineIncludeOrderVersion.Unreal5_7;
 		ExtraModuleNames.Add("RopeStressTests");
+		ExtraModuleNames.Add("RopeSystem");
 		
 	}
 }
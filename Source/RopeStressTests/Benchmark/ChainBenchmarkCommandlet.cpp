@@ -0,0 +1,342 @@
+#include "ChainBenchmarkCommandlet.h"
+#include "RopeStressTests.h"
+#include "ChainInstanceActor.h"
+#include "ChainSimulationSubsystem.h"
+#include "Engine/Engine.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "HAL/PlatformMemory.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/Package.h"
+
+namespace ChainBenchmark
+{
+	/** Value below which Percent of the sorted samples fall */
+	static double Percentile(TConstArrayView<double> SortedValues, double Percent)
+	{
+		if (SortedValues.Num() == 0)
+		{
+			return 0.0;
+		}
+
+		const int32 Index = FMath::Clamp(FMath::CeilToInt32(Percent * SortedValues.Num()) - 1, 0, SortedValues.Num() - 1);
+		return SortedValues[Index];
+	}
+
+	/** "name": { "mean": .., "p50": .., "p95": .., "p99": .., "max": .. } */
+	static FString SummarizeMetric(const TCHAR* Name, TArray<double> Values)
+	{
+		Values.Sort();
+
+		double Sum = 0.0;
+		for (double Value : Values)
+		{
+			Sum += Value;
+		}
+		const double Mean = Values.Num() > 0 ? Sum / Values.Num() : 0.0;
+		const double Max = Values.Num() > 0 ? Values.Last() : 0.0;
+
+		return FString::Printf(TEXT("\t\t\"%s\": { \"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f }"),
+			Name, Mean, Percentile(Values, 0.50), Percentile(Values, 0.95), Percentile(Values, 0.99), Max);
+	}
+}
+
+UChainBenchmarkCommandlet::UChainBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UChainBenchmarkCommandlet::Main(const FString& Params)
+{
+	const FBenchmarkConfig Config = ParseConfig(Params);
+
+	UChainProfile* Profile = MakeProfile(Config);
+	if (!Profile)
+	{
+		UE_LOG(LogRopeStressTests, Error, TEXT("ChainBenchmark: could not load profile '%s'"), *Config.ProfilePath);
+		return 1;
+	}
+
+	UE_LOG(LogRopeStressTests, Display, TEXT("ChainBenchmark: %d chains x %d segments, backend %s, render mode %s, %d frames (+%d warmup) at %.4fs"),
+		Config.NumChains, Profile->Visual.DefaultSegmentCount,
+		*UEnum::GetValueAsString(Profile->Simulation.Backend), *UEnum::GetValueAsString(Profile->Visual.RenderMode),
+		Config.NumFrames, Config.NumWarmupFrames, Config.DeltaTime);
+
+	// Standalone game world, ticked by hand
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("ChainBenchmarkWorld"));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	World->InitializeActorsForPlay(FURL());
+	World->BeginPlay();
+
+	const uint64 BaselineUsedMemory = FPlatformMemory::GetStats().UsedPhysical;
+	uint64 PeakUsedMemory = BaselineUsedMemory;
+
+	// Chains hang from a square grid, high enough to never touch anything
+	const int32 GridSide = FMath::Max(1, FMath::CeilToInt32(FMath::Sqrt(static_cast<float>(Config.NumChains))));
+
+	TArray<AChainInstanceActor*> Chains;
+	TArray<FVector> BaseLocations;
+	Chains.Reserve(Config.NumChains);
+	BaseLocations.Reserve(Config.NumChains);
+
+	for (int32 ChainIndex = 0; ChainIndex < Config.NumChains; ++ChainIndex)
+	{
+		const FVector Location((ChainIndex % GridSide) * Config.Spacing, (ChainIndex / GridSide) * Config.Spacing, 1000.0f);
+
+		AChainInstanceActor* Chain = World->SpawnActorDeferred<AChainInstanceActor>(AChainInstanceActor::StaticClass(), FTransform(Location));
+		if (!Chain)
+		{
+			continue;
+		}
+
+		Chain->Profile = Profile;
+		Chain->StartAnchor.bUseWorldLocation = true;
+		Chain->StartAnchor.WorldLocation = Location;
+		Chain->FinishSpawning(FTransform(Location));
+
+		Chains.Add(Chain);
+		BaseLocations.Add(Location);
+	}
+
+	UChainSimulationSubsystem* Subsystem = World->GetSubsystem<UChainSimulationSubsystem>();
+
+	// Physics scene time, from the start of the physics frame until its results are synced back.
+	// Everything ticking in TG_DuringPhysics runs in between and is counted too.
+	double PhysicsStartTime = 0.0;
+	double PhysicsTime = 0.0;
+	FPhysScene* PhysicsScene = World->GetPhysicsScene();
+	FDelegateHandle PhysicsPreTickHandle;
+	FDelegateHandle PhysicsPostTickHandle;
+	if (PhysicsScene)
+	{
+		PhysicsPreTickHandle = PhysicsScene->OnPhysScenePreTick.AddLambda([&PhysicsStartTime](FPhysScene_Chaos*, float)
+		{
+			PhysicsStartTime = FPlatformTime::Seconds();
+		});
+		PhysicsPostTickHandle = PhysicsScene->OnPhysScenePostTick.AddLambda([&PhysicsStartTime, &PhysicsTime](FChaosScene*)
+		{
+			PhysicsTime += FPlatformTime::Seconds() - PhysicsStartTime;
+		});
+	}
+
+	TArray<FFrameSample> Samples;
+	Samples.Reserve(Config.NumFrames);
+
+	double Time = 0.0;
+	for (int32 Frame = 0; Frame < Config.NumWarmupFrames + Config.NumFrames; ++Frame)
+	{
+		Time += Config.DeltaTime;
+		AnimateAnchors(Chains, BaseLocations, Time);
+
+		PhysicsTime = 0.0;
+		const double FrameStartTime = FPlatformTime::Seconds();
+		World->Tick(LEVELTICK_All, Config.DeltaTime);
+		const double FrameTime = FPlatformTime::Seconds() - FrameStartTime;
+
+		PeakUsedMemory = FMath::Max<uint64>(PeakUsedMemory, FPlatformMemory::GetStats().UsedPhysical);
+
+		if (Frame < Config.NumWarmupFrames)
+		{
+			continue;
+		}
+
+		FFrameSample& Sample = Samples.AddDefaulted_GetRef();
+		Sample.FrameMs = FrameTime * 1000.0;
+		Sample.ChainMs = Subsystem ? Subsystem->GetLastTickTime() * 1000.0 : 0.0;
+		Sample.PhysicsMs = PhysicsTime * 1000.0;
+		Sample.GameThreadMs = FMath::Max(0.0, Sample.FrameMs - Sample.ChainMs - Sample.PhysicsMs);
+	}
+
+	if (PhysicsScene)
+	{
+		PhysicsScene->OnPhysScenePreTick.Remove(PhysicsPreTickHandle);
+		PhysicsScene->OnPhysScenePostTick.Remove(PhysicsPostTickHandle);
+	}
+
+	const bool bWritten = WriteResults(Config, *Profile, Samples, PeakUsedMemory, BaselineUsedMemory);
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	return bWritten ? 0 : 1;
+}
+
+UChainBenchmarkCommandlet::FBenchmarkConfig UChainBenchmarkCommandlet::ParseConfig(const FString& Params)
+{
+	FBenchmarkConfig Config;
+	const TCHAR* Cmd = *Params;
+
+	FParse::Value(Cmd, TEXT("Chains="), Config.NumChains);
+	Config.bOverrideSegments = FParse::Value(Cmd, TEXT("Segments="), Config.NumSegments);
+	FParse::Value(Cmd, TEXT("Frames="), Config.NumFrames);
+	FParse::Value(Cmd, TEXT("Warmup="), Config.NumWarmupFrames);
+	FParse::Value(Cmd, TEXT("DeltaTime="), Config.DeltaTime);
+	FParse::Value(Cmd, TEXT("Spacing="), Config.Spacing);
+	FParse::Value(Cmd, TEXT("Profile="), Config.ProfilePath);
+	FParse::Value(Cmd, TEXT("Output="), Config.OutputPath);
+	Config.bAllowSleep = FParse::Param(Cmd, TEXT("AllowSleep"));
+
+	Config.NumChains = FMath::Max(1, Config.NumChains);
+	Config.NumSegments = FMath::Max(1, Config.NumSegments);
+	Config.NumFrames = FMath::Max(1, Config.NumFrames);
+	Config.NumWarmupFrames = FMath::Max(0, Config.NumWarmupFrames);
+	Config.DeltaTime = FMath::Max(KINDA_SMALL_NUMBER, Config.DeltaTime);
+
+	FString BackendName;
+	if (FParse::Value(Cmd, TEXT("Backend="), BackendName))
+	{
+		const int64 Value = StaticEnum<EChainSimulationBackend>()->GetValueByNameString(BackendName);
+		if (Value != INDEX_NONE)
+		{
+			Config.Backend = static_cast<EChainSimulationBackend>(Value);
+			Config.bOverrideBackend = true;
+		}
+		else
+		{
+			UE_LOG(LogRopeStressTests, Warning, TEXT("ChainBenchmark: unknown backend '%s'"), *BackendName);
+		}
+	}
+
+	FString RenderModeName;
+	if (FParse::Value(Cmd, TEXT("RenderMode="), RenderModeName))
+	{
+		const int64 Value = StaticEnum<EChainRenderMode>()->GetValueByNameString(RenderModeName);
+		if (Value != INDEX_NONE)
+		{
+			Config.RenderMode = static_cast<EChainRenderMode>(Value);
+			Config.bOverrideRenderMode = true;
+		}
+		else
+		{
+			UE_LOG(LogRopeStressTests, Warning, TEXT("ChainBenchmark: unknown render mode '%s'"), *RenderModeName);
+		}
+	}
+
+	if (Config.OutputPath.IsEmpty())
+	{
+		Config.OutputPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / FString::Printf(TEXT("ChainBench_%s"), *FDateTime::Now().ToString());
+	}
+
+	return Config;
+}
+
+UChainProfile* UChainBenchmarkCommandlet::MakeProfile(const FBenchmarkConfig& Config) const
+{
+	UChainProfile* Profile = nullptr;
+
+	if (!Config.ProfilePath.IsEmpty())
+	{
+		// Work on a copy, the asset itself is never modified
+		UChainProfile* Asset = LoadObject<UChainProfile>(nullptr, *Config.ProfilePath);
+		if (!Asset)
+		{
+			return nullptr;
+		}
+		Profile = DuplicateObject<UChainProfile>(Asset, GetTransientPackage());
+
+		// Switches given explicitly still apply on top of the asset
+		if (Config.bOverrideSegments)
+		{
+			Profile->Visual.DefaultSegmentCount = Config.NumSegments;
+		}
+		if (Config.bOverrideBackend)
+		{
+			Profile->Simulation.Backend = Config.Backend;
+		}
+		if (Config.bOverrideRenderMode)
+		{
+			Profile->Visual.RenderMode = Config.RenderMode;
+		}
+	}
+	else
+	{
+		Profile = NewObject<UChainProfile>(GetTransientPackage());
+		Profile->Simulation.Backend = Config.Backend;
+		Profile->Visual.RenderMode = Config.RenderMode;
+		Profile->Visual.LinkMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+		Profile->Visual.LinkRelativeTransform = FTransform(FQuat::Identity, FVector::ZeroVector, FVector(0.18f, 0.06f, 0.06f));
+		Profile->Visual.DefaultSegmentCount = Config.NumSegments;
+		Profile->Visual.DefaultLength = Config.NumSegments * 20.0f;
+		Profile->bSupportsLooseEnd = true;
+	}
+
+	Profile->Sleep.bAllowSleep = Config.bAllowSleep;
+	return Profile;
+}
+
+void UChainBenchmarkCommandlet::AnimateAnchors(TConstArrayView<AChainInstanceActor*> Chains, TConstArrayView<FVector> BaseLocations, double Time)
+{
+	// Each chain gets its own phase so the load is spread, but the motion is the same on every run
+	for (int32 ChainIndex = 0; ChainIndex < Chains.Num(); ++ChainIndex)
+	{
+		const double Phase = Time * 1.5 + ChainIndex * 0.37;
+		const FVector Offset(FMath::Sin(Phase) * 40.0, FMath::Cos(Phase * 0.7) * 40.0, FMath::Sin(Phase * 0.5) * 15.0);
+
+		// Written in place, SetStartAnchor would rebuild auto rebuilding chains
+		Chains[ChainIndex]->StartAnchor.WorldLocation = BaseLocations[ChainIndex] + Offset;
+	}
+}
+
+bool UChainBenchmarkCommandlet::WriteResults(const FBenchmarkConfig& Config, const UChainProfile& Profile, TConstArrayView<FFrameSample> Samples, uint64 PeakUsedMemory, uint64 BaselineUsedMemory)
+{
+	TArray<double> FrameMs;
+	TArray<double> ChainMs;
+	TArray<double> PhysicsMs;
+	TArray<double> GameThreadMs;
+
+	FString Csv = TEXT("Frame,FrameMs,ChainMs,PhysicsMs,GameThreadMs\n");
+	for (int32 Index = 0; Index < Samples.Num(); ++Index)
+	{
+		const FFrameSample& Sample = Samples[Index];
+		FrameMs.Add(Sample.FrameMs);
+		ChainMs.Add(Sample.ChainMs);
+		PhysicsMs.Add(Sample.PhysicsMs);
+		GameThreadMs.Add(Sample.GameThreadMs);
+		Csv += FString::Printf(TEXT("%d,%.4f,%.4f,%.4f,%.4f\n"), Index, Sample.FrameMs, Sample.ChainMs, Sample.PhysicsMs, Sample.GameThreadMs);
+	}
+
+	const double MB = 1024.0 * 1024.0;
+
+	FString Json = TEXT("{\n");
+	Json += TEXT("\t\"config\": {\n");
+	Json += FString::Printf(TEXT("\t\t\"chains\": %d,\n"), Config.NumChains);
+	Json += FString::Printf(TEXT("\t\t\"segments\": %d,\n"), Profile.Visual.DefaultSegmentCount);
+	Json += FString::Printf(TEXT("\t\t\"backend\": \"%s\",\n"), *UEnum::GetValueAsString(Profile.Simulation.Backend));
+	Json += FString::Printf(TEXT("\t\t\"renderMode\": \"%s\",\n"), *UEnum::GetValueAsString(Profile.Visual.RenderMode));
+	Json += FString::Printf(TEXT("\t\t\"profile\": \"%s\",\n"), *Config.ProfilePath);
+	Json += FString::Printf(TEXT("\t\t\"frames\": %d,\n"), Config.NumFrames);
+	Json += FString::Printf(TEXT("\t\t\"warmup\": %d,\n"), Config.NumWarmupFrames);
+	Json += FString::Printf(TEXT("\t\t\"deltaTime\": %.6f,\n"), Config.DeltaTime);
+	Json += FString::Printf(TEXT("\t\t\"allowSleep\": %s\n"), Config.bAllowSleep ? TEXT("true") : TEXT("false"));
+	Json += TEXT("\t},\n");
+	Json += TEXT("\t\"timingsMs\": {\n");
+	Json += ChainBenchmark::SummarizeMetric(TEXT("frame"), FrameMs) + TEXT(",\n");
+	Json += ChainBenchmark::SummarizeMetric(TEXT("chain"), ChainMs) + TEXT(",\n");
+	Json += ChainBenchmark::SummarizeMetric(TEXT("physics"), PhysicsMs) + TEXT(",\n");
+	Json += ChainBenchmark::SummarizeMetric(TEXT("gameThread"), GameThreadMs) + TEXT("\n");
+	Json += TEXT("\t},\n");
+	Json += TEXT("\t\"memoryMB\": {\n");
+	Json += FString::Printf(TEXT("\t\t\"baseline\": %.2f,\n"), BaselineUsedMemory / MB);
+	Json += FString::Printf(TEXT("\t\t\"peak\": %.2f,\n"), PeakUsedMemory / MB);
+	Json += FString::Printf(TEXT("\t\t\"delta\": %.2f\n"), (PeakUsedMemory - FMath::Min(PeakUsedMemory, BaselineUsedMemory)) / MB);
+	Json += TEXT("\t}\n");
+	Json += TEXT("}\n");
+
+	const FString JsonPath = Config.OutputPath + TEXT(".json");
+	const FString CsvPath = Config.OutputPath + TEXT(".csv");
+
+	if (!FFileHelper::SaveStringToFile(Json, *JsonPath) || !FFileHelper::SaveStringToFile(Csv, *CsvPath))
+	{
+		UE_LOG(LogRopeStressTests, Error, TEXT("ChainBenchmark: could not write results to %s"), *Config.OutputPath);
+		return false;
+	}
+
+	UE_LOG(LogRopeStressTests, Display, TEXT("ChainBenchmark: results written to %s"), *JsonPath);
+	return true;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ChainProfile.h"
+#include "ChainBenchmarkCommandlet.generated.h"
+
+class AChainInstanceActor;
+
+/**
+ *  Headless chain stress benchmark.
+ *  Spawns a grid of chain actors in a transient game world, steps it a fixed number of frames
+ *  with a fixed delta time and writes frame, chain, physics scene and remaining game thread times
+ *  to <Output>.json and <Output>.csv. Physics time spans the physics scene frame, so it includes whatever
+ *  ticks in TG_DuringPhysics. With -Profile, the -Segments, -Backend and -RenderMode switches given
+ *  override the asset, and the results record the values the profile actually used.
+ *
+ *  UnrealEditor-Cmd RopeStressTests.uproject -run=ChainBenchmark -nullrhi -unattended
+ *      -Chains=256 -Segments=32 -Backend=XPBD -RenderMode=Instanced -Frames=600 -Warmup=60
+ *      [-Profile=/Game/Chains/DA_Rope.DA_Rope] [-DeltaTime=0.016667] [-Spacing=150] [-AllowSleep]
+ *      [-Output=Saved/Benchmarks/ChainBench]
+ */
+UCLASS()
+class UChainBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Constructor */
+	UChainBenchmarkCommandlet();
+
+	// ~Begin UCommandlet interface
+
+	/** Runs the benchmark, returns 0 on success */
+	virtual int32 Main(const FString& Params) override;
+
+	// ~End UCommandlet interface
+
+protected:
+
+	/** Benchmark configuration parsed from the command line */
+	struct FBenchmarkConfig
+	{
+		int32 NumChains = 64;
+		int32 NumSegments = 16;
+		int32 NumFrames = 600;
+		int32 NumWarmupFrames = 60;
+		float DeltaTime = 1.0f / 60.0f;
+		float Spacing = 150.0f;
+		bool bAllowSleep = false;
+		bool bOverrideSegments = false;
+		bool bOverrideBackend = false;
+		bool bOverrideRenderMode = false;
+		EChainSimulationBackend Backend = EChainSimulationBackend::XPBD;
+		EChainRenderMode RenderMode = EChainRenderMode::LinkComponents;
+		FString ProfilePath;
+		FString OutputPath;
+	};
+
+	/** Per-frame timings, in milliseconds */
+	struct FFrameSample
+	{
+		double FrameMs = 0.0;
+		double ChainMs = 0.0;
+		/** Physics scene pre tick to post tick, which includes everything ticking in TG_DuringPhysics. */
+		double PhysicsMs = 0.0;
+		double GameThreadMs = 0.0;
+	};
+
+	/** Reads the command line switches into a config */
+	static FBenchmarkConfig ParseConfig(const FString& Params);
+
+	/** Loads the profile asset, or builds a transient one from the config */
+	UChainProfile* MakeProfile(const FBenchmarkConfig& Config) const;
+
+	/** Moves the chain anchors along deterministic paths so the chains never settle */
+	static void AnimateAnchors(TConstArrayView<AChainInstanceActor*> Chains, TConstArrayView<FVector> BaseLocations, double Time);
+
+	/** Writes the summary (JSON), labelled with the settings the profile ran with, and the per-frame samples (CSV) */
+	static bool WriteResults(const FBenchmarkConfig& Config, const UChainProfile& Profile, TConstArrayView<FFrameSample> Samples, uint64 PeakUsedMemory, uint64 BaselineUsedMemory);
+};
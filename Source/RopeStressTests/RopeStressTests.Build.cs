@@ -18,13 +18,15 @@ public class RopeStressTests : ModuleRules
 			"StateTreeModule",
 			"GameplayStateTreeModule",
 			"UMG",
-			"Slate"
+			"Slate",
+			"ChainConstraint"
 		});
 
 		PrivateDependencyModuleNames.AddRange(new string[] { });
 
 		PublicIncludePaths.AddRange(new string[] {
 			"RopeStressTests",
+			"RopeStressTests/Benchmark",
 			"RopeStressTests/Variant_Platforming",
 			"RopeStressTests/Variant_Platforming/Animation",
 			"RopeStressTests/Variant_Combat",
@@ -11,5 +11,6 @@ public class RopeStressTestsEditorTarget : TargetRules
 		DefaultBuildSettings = BuildSettingsVersion.V6;
 		IncludeOrderVersion = EngineIncludeOrderVersion.Unreal5_7;
 		ExtraModuleNames.Add("RopeStressTests");
+		ExtraModuleNames.Add("RopeSystem");
 	}
 }
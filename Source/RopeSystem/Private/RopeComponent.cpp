@@ -0,0 +1,267 @@
+#include "RopeComponent.h"
+#include "RopeSubsystem.h"
+#include "Engine/World.h"
+
+URopeComponent::URopeComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	// Stepped by URopeSubsystem with every other rope of the world
+	PrimaryComponentTick.bCanEverTick = false;
+
+	SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	SetGenerateOverlapEvents(false);
+	bUseAsyncCooking = true;
+}
+
+void URopeComponent::OnRegister()
+{
+	Super::OnRegister();
+
+	InitializeParticles();
+	UploadMesh();
+
+	if (UWorld* World = GetWorld())
+	{
+		if (URopeSubsystem* Subsystem = World->GetSubsystem<URopeSubsystem>())
+		{
+			Subsystem->RegisterRope(this);
+		}
+	}
+}
+
+void URopeComponent::OnUnregister()
+{
+	if (UWorld* World = GetWorld())
+	{
+		if (URopeSubsystem* Subsystem = World->GetSubsystem<URopeSubsystem>())
+		{
+			Subsystem->UnregisterRope(this);
+		}
+	}
+
+	Super::OnUnregister();
+}
+
+#if WITH_EDITOR
+void URopeComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	ResetRope();
+}
+#endif
+
+void URopeComponent::ResetRope()
+{
+	InitializeParticles();
+	WakeRope();
+	UploadMesh();
+}
+
+void URopeComponent::SetPinAnchor(int32 PinIndex, const FChainAnchor& Anchor)
+{
+	if (!Pins.IsValidIndex(PinIndex)) return;
+
+	Pins[PinIndex].Anchor = Anchor;
+	WakeRope();
+}
+
+void URopeComponent::WakeRope()
+{
+	bSleeping = false;
+	StillFrames = 0;
+}
+
+void URopeComponent::GetParticlePositions(TArray<FVector>& OutPositions) const
+{
+	OutPositions.SetNumUninitialized(Positions.Num());
+	for (int32 i = 0; i < Positions.Num(); ++i)
+	{
+		OutPositions[i] = FVector(Positions[i]);
+	}
+}
+
+int32 URopeComponent::GetPinParticle(const FRopePin& Pin) const
+{
+	return FMath::Clamp(FMath::RoundToInt(Pin.Position * NumSegments), 0, NumSegments);
+}
+
+FVector URopeComponent::ResolvePinLocation(int32 PinIndex) const
+{
+	if (PinIndex == INDEX_NONE)
+	{
+		return GetComponentLocation();
+	}
+
+	const FChainAnchor& Anchor = Pins[PinIndex].Anchor;
+	return Anchor.bUseWorldLocation ? Anchor.WorldLocation : Anchor.ResolveLocation();
+}
+
+void URopeComponent::InitializeParticles()
+{
+	NumSegments = FMath::Max(1, NumSegments);
+	SegmentLength = FMath::Max(1.0f, Length) / NumSegments;
+	PrevDeltaTime = 0.0f;
+
+	const int32 NumParticles = NumSegments + 1;
+	Positions.SetNumUninitialized(NumParticles);
+	InvMasses.Init(1.0f, NumParticles);
+
+	// Pinned particles, start pin first, and their locations in rope order for the layout
+	PinnedParticles.Reset();
+	PinTargets.Reset();
+	TArray<TPair<int32, FVector3f>> Keys;
+	for (int32 PinIndex = bPinStart ? INDEX_NONE : 0; PinIndex < Pins.Num(); ++PinIndex)
+	{
+		const int32 Particle = PinIndex == INDEX_NONE ? 0 : GetPinParticle(Pins[PinIndex]);
+		const FVector3f Location(ResolvePinLocation(PinIndex));
+
+		PinnedParticles.Add(Particle);
+		PinTargets.Add(Location);
+		InvMasses[Particle] = 0.0f;
+		Keys.Emplace(Particle, Location);
+	}
+
+	if (Keys.Num() == 0)
+	{
+		Keys.Emplace(0, FVector3f(GetComponentLocation()));
+	}
+	Keys.StableSort([](const TPair<int32, FVector3f>& A, const TPair<int32, FVector3f>& B) { return A.Key < B.Key; });
+
+	// Between two pins the rope sags in a V of the right length, outside them it hangs straight down
+	for (int32 i = 0; i <= Keys[0].Key; ++i)
+	{
+		Positions[i] = Keys[0].Value - FVector3f::UpVector * (SegmentLength * (Keys[0].Key - i));
+	}
+	for (int32 KeyIndex = 0; KeyIndex + 1 < Keys.Num(); ++KeyIndex)
+	{
+		const int32 First = Keys[KeyIndex].Key;
+		const int32 Last = Keys[KeyIndex + 1].Key;
+		const FVector3f A = Keys[KeyIndex].Value;
+		const FVector3f B = Keys[KeyIndex + 1].Value;
+
+		const float HalfLength = SegmentLength * (Last - First) * 0.5f;
+		const float HalfSpan = FVector3f::Dist(A, B) * 0.5f;
+		const FVector3f Middle = (A + B) * 0.5f - FVector3f::UpVector * FMath::Sqrt(FMath::Max(0.0f, FMath::Square(HalfLength) - FMath::Square(HalfSpan)));
+
+		for (int32 i = First + 1; i <= Last; ++i)
+		{
+			const float Alpha = static_cast<float>(i - First) / (Last - First) * 2.0f;
+			Positions[i] = Alpha <= 1.0f ? FMath::Lerp(A, Middle, Alpha) : FMath::Lerp(Middle, B, Alpha - 1.0f);
+		}
+	}
+	for (int32 i = Keys.Last().Key + 1; i < NumParticles; ++i)
+	{
+		Positions[i] = Keys.Last().Value - FVector3f::UpVector * (SegmentLength * (i - Keys.Last().Key));
+	}
+
+	PrevPositions = Positions;
+	BuildTube();
+}
+
+bool URopeComponent::UpdatePinTargets()
+{
+	bool bMoved = false;
+	for (int32 Slot = 0; Slot < PinnedParticles.Num(); ++Slot)
+	{
+		const int32 PinIndex = bPinStart ? Slot - 1 : Slot;
+		const FVector3f Target(ResolvePinLocation(PinIndex));
+
+		bMoved |= FVector3f::DistSquared(Target, Positions[PinnedParticles[Slot]]) > FMath::Square(0.01f);
+		PinTargets[Slot] = Target;
+	}
+	return bMoved;
+}
+
+void URopeComponent::Simulate(float DeltaTime, const FVector3f& Gravity)
+{
+	DeltaTime = FMath::Min(DeltaTime, MaxDeltaTime);
+	if (DeltaTime <= 0.0f || Positions.Num() < 2) return;
+
+	for (int32 Slot = 0; Slot < PinnedParticles.Num(); ++Slot)
+	{
+		Positions[PinnedParticles[Slot]] = PinTargets[Slot];
+		PrevPositions[PinnedParticles[Slot]] = PinTargets[Slot];
+	}
+
+	// Time corrected Verlet: velocities are rescaled when the frame time changes
+	const float TimeRatio = PrevDeltaTime > 0.0f ? DeltaTime / PrevDeltaTime : 1.0f;
+	const float DampingFactor = FMath::Pow(1.0f - FMath::Clamp(Damping, 0.0f, 0.99f), DeltaTime) * TimeRatio;
+	const FVector3f Acceleration = Gravity * (GravityScale * DeltaTime * DeltaTime);
+	PrevDeltaTime = DeltaTime;
+
+	const int32 NumParticles = Positions.Num();
+	for (int32 i = 0; i < NumParticles; ++i)
+	{
+		if (InvMasses[i] == 0.0f) continue;
+
+		const FVector3f Position = Positions[i];
+		Positions[i] += (Position - PrevPositions[i]) * DampingFactor + Acceleration;
+		PrevPositions[i] = Position;
+	}
+
+	for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+	{
+		for (int32 i = 0; i + 1 < NumParticles; ++i)
+		{
+			const float WeightSum = InvMasses[i] + InvMasses[i + 1];
+			if (WeightSum == 0.0f) continue;
+
+			const FVector3f Delta = Positions[i + 1] - Positions[i];
+			const float Distance = Delta.Size();
+			if (Distance <= UE_SMALL_NUMBER) continue;
+
+			const FVector3f Correction = Delta * ((Distance - SegmentLength) / (Distance * WeightSum));
+			Positions[i] += Correction * InvMasses[i];
+			Positions[i + 1] -= Correction * InvMasses[i + 1];
+		}
+	}
+
+	// Sleep once every particle has stayed under the threshold for SleepFrames steps
+	if (bAllowSleep)
+	{
+		const float ThresholdSq = FMath::Square(SleepSpeedThreshold * DeltaTime);
+		bool bStill = true;
+		for (int32 i = 0; i < NumParticles && bStill; ++i)
+		{
+			bStill = FVector3f::DistSquared(Positions[i], PrevPositions[i]) <= ThresholdSq;
+		}
+
+		StillFrames = bStill ? StillFrames + 1 : 0;
+		bSleeping = StillFrames >= SleepFrames;
+	}
+
+	BuildTube();
+}
+
+void URopeComponent::BuildTube()
+{
+	const FTransform& ComponentTransform = GetComponentTransform();
+
+	TubePoints.SetNumUninitialized(Positions.Num());
+	for (int32 i = 0; i < Positions.Num(); ++i)
+	{
+		TubePoints[i] = ComponentTransform.InverseTransformPosition(FVector(Positions[i]));
+	}
+
+	bTopologyChanged |= TubeBuffers.Build(TubePoints, Radius, RadialSegments, Subdivisions);
+	bMeshDirty = true;
+}
+
+void URopeComponent::UploadMesh()
+{
+	if (!bMeshDirty) return;
+
+	static const TArray<FColor> NoColors;
+	if (bTopologyChanged || GetNumSections() == 0)
+	{
+		CreateMeshSection(0, TubeBuffers.Vertices, TubeBuffers.Triangles, TubeBuffers.Normals, TubeBuffers.UVs, NoColors, TubeBuffers.Tangents, false);
+	}
+	else
+	{
+		UpdateMeshSection(0, TubeBuffers.Vertices, TubeBuffers.Normals, TubeBuffers.UVs, NoColors, TubeBuffers.Tangents);
+	}
+
+	bMeshDirty = false;
+	bTopologyChanged = false;
+}
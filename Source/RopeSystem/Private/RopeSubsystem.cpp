@@ -0,0 +1,80 @@
+#include "RopeSubsystem.h"
+#include "RopeComponent.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Stats/Stats.h"
+
+/** Rope stats, "stat Rope" in the console. */
+DECLARE_STATS_GROUP(TEXT("Rope"), STATGROUP_Rope, STATCAT_Advanced);
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Awake Ropes"), STAT_RopeAwake, STATGROUP_Rope);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sleeping Ropes"), STAT_RopeSleeping, STATGROUP_Rope);
+
+DECLARE_CYCLE_STAT(TEXT("Pins"), STAT_RopePins, STATGROUP_Rope);
+DECLARE_CYCLE_STAT(TEXT("Simulate"), STAT_RopeSimulate, STATGROUP_Rope);
+DECLARE_CYCLE_STAT(TEXT("Mesh Upload"), STAT_RopeMeshUpload, STATGROUP_Rope);
+
+TStatId URopeSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(URopeSubsystem, STATGROUP_Tickables);
+}
+
+void URopeSubsystem::RegisterRope(URopeComponent* Rope)
+{
+	if (Rope)
+	{
+		Ropes.AddUnique(Rope);
+	}
+}
+
+void URopeSubsystem::UnregisterRope(URopeComponent* Rope)
+{
+	Ropes.RemoveSwap(Rope);
+}
+
+void URopeSubsystem::Tick(float DeltaTime)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(URopeSubsystem::Tick);
+
+	// Anchors are resolved on the game thread; a moving pin wakes its rope
+	AwakeRopes.Reset();
+	{
+		SCOPE_CYCLE_COUNTER(STAT_RopePins);
+		for (URopeComponent* Rope : Ropes)
+		{
+			if (!IsValid(Rope)) continue;
+
+			if (Rope->UpdatePinTargets())
+			{
+				Rope->WakeRope();
+			}
+			if (!Rope->bSleeping)
+			{
+				AwakeRopes.Add(Rope);
+			}
+		}
+	}
+
+	SET_DWORD_STAT(STAT_RopeAwake, AwakeRopes.Num());
+	SET_DWORD_STAT(STAT_RopeSleeping, Ropes.Num() - AwakeRopes.Num());
+	if (AwakeRopes.Num() == 0) return;
+
+	// Each rope only touches its own arrays
+	{
+		SCOPE_CYCLE_COUNTER(STAT_RopeSimulate);
+		const FVector3f Gravity(0.0f, 0.0f, GetWorld()->GetGravityZ());
+		ParallelFor(AwakeRopes.Num(), [this, DeltaTime, &Gravity](int32 Index)
+		{
+			AwakeRopes[Index]->Simulate(DeltaTime, Gravity);
+		});
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_RopeMeshUpload);
+		for (URopeComponent* Rope : AwakeRopes)
+		{
+			Rope->UploadMesh();
+		}
+	}
+}
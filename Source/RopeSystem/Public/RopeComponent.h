@@ -0,0 +1,169 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProceduralMeshComponent.h"
+#include "ChainInstanceActor.h"
+#include "ChainTubeMesh.h"
+#include "RopeComponent.generated.h"
+
+/** Point of a rope held by an anchor. */
+USTRUCT(BlueprintType)
+struct ROPESYSTEM_API FRopePin
+{
+	GENERATED_BODY()
+
+	/** Where along the rope the pin holds it, 0 = start, 1 = end. Snapped to the closest particle. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pin", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float Position = 1.0f;
+
+	/** What the pin follows, resolved like chain anchors: a world location, or a component / socket. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pin")
+	FChainAnchor Anchor;
+};
+
+/**
+ * Cosmetic rope (power lines, hanging wires, cables) simulated with position-based Verlet integration,
+ * with no physics body at all. Particles live in flat arrays on the component; every rope of the world
+ * is stepped in one parallel pass by URopeSubsystem, and ropes at rest sleep until one of their pins moves.
+ * The rope is drawn as a tube swept along its particles.
+ */
+UCLASS(ClassGroup = (Rendering), meta = (BlueprintSpawnableComponent))
+class ROPESYSTEM_API URopeComponent : public UProceduralMeshComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	URopeComponent(const FObjectInitializer& ObjectInitializer);
+
+	/** Rest length of the rope, in centimeters. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rope", meta = (ClampMin = "1.0"))
+	float Length = 300.0f;
+
+	/** Number of segments between particles. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rope", meta = (ClampMin = "1", ClampMax = "256"))
+	int32 NumSegments = 16;
+
+	/** If true, the start of the rope follows this component. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rope")
+	bool bPinStart = true;
+
+	/** Additional pins, e.g. the far end of a power line on the next pole's socket. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rope")
+	TArray<FRopePin> Pins;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rope|Simulation")
+	float GravityScale = 1.0f;
+
+	/** Fraction of the velocity lost per second. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rope|Simulation", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float Damping = 0.1f;
+
+	/** Distance constraint iterations per step. Cosmetic ropes rarely need more than a few. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rope|Simulation", meta = (ClampMin = "1", ClampMax = "32"))
+	int32 Iterations = 4;
+
+	/** Longest step simulated; slower frames are simulated in slow motion rather than exploding. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rope|Simulation", meta = (ClampMin = "0.001"))
+	float MaxDeltaTime = 1.0f / 30.0f;
+
+	/** If true, a rope whose particles all move slower than SleepSpeedThreshold for SleepFrames frames stops simulating. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rope|Sleep")
+	bool bAllowSleep = true;
+
+	/** Speed below which a particle is at rest, in cm/s. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rope|Sleep", meta = (ClampMin = "0.0"))
+	float SleepSpeedThreshold = 1.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rope|Sleep", meta = (ClampMin = "1"))
+	int32 SleepFrames = 30;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rope|Rendering", meta = (ClampMin = "0.01"))
+	float Radius = 1.5f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rope|Rendering", meta = (ClampMin = "3", ClampMax = "32"))
+	int32 RadialSegments = 6;
+
+	/** Rings per segment of the smoothed tube. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rope|Rendering", meta = (ClampMin = "1", ClampMax = "8"))
+	int32 Subdivisions = 2;
+
+	/** Lays the rope out again from its pins and wakes it. */
+	UFUNCTION(BlueprintCallable, Category = "Rope")
+	void ResetRope();
+
+	/** Changes what a pin follows. */
+	UFUNCTION(BlueprintCallable, Category = "Rope")
+	void SetPinAnchor(int32 PinIndex, const FChainAnchor& Anchor);
+
+	/** Wakes the rope up if it sleeps. */
+	UFUNCTION(BlueprintCallable, Category = "Rope")
+	void WakeRope();
+
+	UFUNCTION(BlueprintPure, Category = "Rope")
+	bool IsRopeSleeping() const { return bSleeping; }
+
+	/** World space particle positions, start to end. */
+	UFUNCTION(BlueprintCallable, Category = "Rope")
+	void GetParticlePositions(TArray<FVector>& OutPositions) const;
+
+	int32 GetNumParticles() const { return Positions.Num(); }
+
+protected:
+
+	// ~Begin UActorComponent interface
+	virtual void OnRegister() override;
+	virtual void OnUnregister() override;
+	// ~End UActorComponent interface
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+private:
+
+	friend class URopeSubsystem;
+
+	/** Resolves the pin targets. Game thread, before the parallel step. Returns true if a pin moved. */
+	bool UpdatePinTargets();
+
+	/** Verlet step of the particles, then tube rebuild. Touches nothing but the rope's own arrays. */
+	void Simulate(float DeltaTime, const FVector3f& Gravity);
+
+	/** Sweeps the tube along the particles, in component space. */
+	void BuildTube();
+
+	/** Uploads the tube built by Simulate. Game thread. */
+	void UploadMesh();
+
+	/** Allocates the particles and lays them out between the pins. */
+	void InitializeParticles();
+
+	/** World location of the pinned particle of pin PinIndex, INDEX_NONE for the start pin. */
+	FVector ResolvePinLocation(int32 PinIndex) const;
+
+	/** Particle held by a pin. */
+	int32 GetPinParticle(const FRopePin& Pin) const;
+
+	/** Particle state, world space. InvMass is 0 for pinned particles. */
+	TArray<FVector3f> Positions;
+	TArray<FVector3f> PrevPositions;
+	TArray<float> InvMasses;
+
+	/** Pinned particles and their targets for the next step, start pin first if any. */
+	TArray<int32> PinnedParticles;
+	TArray<FVector3f> PinTargets;
+
+	float SegmentLength = 0.0f;
+	float PrevDeltaTime = 0.0f;
+
+	bool bSleeping = false;
+	int32 StillFrames = 0;
+
+	/** Set by Simulate when the tube must be re-uploaded. */
+	bool bMeshDirty = false;
+	bool bTopologyChanged = false;
+
+	FChainTubeMesh TubeBuffers;
+	TArray<FVector> TubePoints;
+};
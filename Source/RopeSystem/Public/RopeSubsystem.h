@@ -0,0 +1,35 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RopeSubsystem.generated.h"
+
+class URopeComponent;
+
+/**
+ * Steps every rope component of the world once per frame:
+ * - pins : anchors are resolved on the game thread, a moving pin wakes its rope
+ * - step : awake ropes are integrated and their tubes rebuilt in one ParallelFor
+ * - upload: rebuilt tubes are sent to their mesh sections
+ */
+UCLASS()
+class ROPESYSTEM_API URopeSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void RegisterRope(URopeComponent* Rope);
+	void UnregisterRope(URopeComponent* Rope);
+
+private:
+
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<URopeComponent>> Ropes;
+
+	/** Ropes stepped this frame. */
+	TArray<URopeComponent*> AwakeRopes;
+};
@@ -0,0 +1,28 @@
+using UnrealBuildTool;
+
+public class RopeSystem : ModuleRules
+{
+    public RopeSystem(ReadOnlyTargetRules Target) : base(Target)
+    {
+        PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+        PublicDependencyModuleNames.AddRange(new string[]
+        {
+            "Core",
+            "CoreUObject",
+            "Engine",
+            "ProceduralMeshComponent",
+            "ChainConstraint"
+        });
+
+        PublicIncludePaths.AddRange(new string[]
+        {
+            "RopeSystem/Public"
+        });
+
+        PrivateIncludePaths.AddRange(new string[]
+        {
+            "RopeSystem/Private"
+        });
+    }
+}
@@ -0,0 +1,8 @@
+#include "CoreMinimal.h"
+#include "Modules/ModuleManager.h"
+
+class FRopeSystemModule : public FDefaultGameModuleImpl
+{
+};
+
+IMPLEMENT_MODULE(FRopeSystemModule, RopeSystem);